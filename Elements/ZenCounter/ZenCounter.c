@@ -24,22 +24,35 @@
 #include <stdlib.h>
 #include <stdio.h>
 
+// Interned property keys
+int _initialValueKey;
+int _counterStepKey;
+int _maxValueKey;
+
+EXTERN_DLL_EXPORT int onImplementationInit(char *params)
+{
+	_initialValueKey = common_intern_key("INITIAL_VALUE");
+	_counterStepKey = common_intern_key("COUNTER_STEP");
+	_maxValueKey = common_intern_key("MAX_VALUE");
+	return 0;
+}
+
 EXTERN_DLL_EXPORT int onNodePreInit(Node* node)
 {
 	node->lastResult = malloc(sizeof(int*));
 	*node->lastResult = malloc(sizeof(int));
-	*((int*)*node->lastResult) = atoi(common_get_node_arg(node, "INITIAL_VALUE"));
+	*((int*)*node->lastResult) = common_get_node_arg_int(node, _initialValueKey);
 	node->lastResultType = RESULT_TYPE_INT;
 	return 0;
 }
 
 EXTERN_DLL_EXPORT int executeAction(Node *node)
 {
-	int currentCounterValue = *(int*)*node->lastResult + atoi(common_get_node_arg(node, "COUNTER_STEP"));
-	node->isConditionMet = currentCounterValue >= atoi(common_get_node_arg(node, "MAX_VALUE"));
+	int currentCounterValue = *(int*)*node->lastResult + common_get_node_arg_int(node, _counterStepKey);
+	node->isConditionMet = currentCounterValue >= common_get_node_arg_int(node, _maxValueKey);
 
-	if (currentCounterValue >= atoi(common_get_node_arg(node, "MAX_VALUE")))
-		currentCounterValue = atoi(common_get_node_arg(node, "INITIAL_VALUE"));
+	if (node->isConditionMet)
+		currentCounterValue = common_get_node_arg_int(node, _initialValueKey);
 
 	*((int*)*node->lastResult) = currentCounterValue;
 
@@ -54,16 +54,18 @@ EXTERN_DLL_EXPORT int executeAction(Node *node)
 EXTERN_DLL_EXPORT Node** getNodesToExecute(Node* node, int* nodesToExecuteCnt)
 {
 	char* result = NULL;
-	coreclr_get_dynamic_nodes(*((int*)(node->implementationContext)), node, &result, IS_MANAGED);
+	const char* rest;
+	strSpan token;
+	int i = 0;
 
-	int numNodesToExecute = 0;
-	char **nodesToExecute = NULL;
-	common_str_split(result, ",", &numNodesToExecute, &nodesToExecute);
+	coreclr_get_dynamic_nodes(*((int*)(node->implementationContext)), node, &result, IS_MANAGED);
 
-	Node** disconnectedNodes = malloc((numNodesToExecute) * sizeof(Node*));
+	// Result holds node ids, each one followed by comma
+	*nodesToExecuteCnt = common_str_count_tokens(result, ",") - 1;
+	Node** disconnectedNodes = malloc((*nodesToExecuteCnt + 1) * sizeof(Node*));
 
-	common_parse_nodes(disconnectedNodes, nodesToExecute, numNodesToExecute - 1);
-	*nodesToExecuteCnt = numNodesToExecute - 1;
-	common_free_splitted_string(nodesToExecute, numNodesToExecute);
+	rest = result;
+	while (i < *nodesToExecuteCnt && common_str_next_token(&rest, ",", &token))
+		disconnectedNodes[i++] = common_get_node_by_span(token.start, token.length);
 	return disconnectedNodes;
 }
\ No newline at end of file
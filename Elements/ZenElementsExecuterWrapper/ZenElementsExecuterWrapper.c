@@ -37,37 +37,39 @@ EXTERN_DLL_EXPORT int onNodePreInit(Node* node)
 
 EXTERN_DLL_EXPORT int executeAction(Node *node)
 {
-	char* result = malloc(100 * sizeof(char));
-	coreclr_execute_action(*((int*)(node->implementationContext)), node, result);
-	int numDisconnectedNodes = 0;
-	char** disconnectedNodes = NULL;
-
-	common_str_split(result, ",", &numDisconnectedNodes, &disconnectedNodes);
+	char result[100];
+	const char* rest = result;
+	strSpan token;
+	int i = 0, disconnectedNodesCnt;
 
-	node->disconnectedNodes = malloc((numDisconnectedNodes - 1) * sizeof(Node*));
-	common_parse_nodes(node->disconnectedNodes, disconnectedNodes, numDisconnectedNodes);
+	coreclr_execute_action(*((int*)(node->implementationContext)), node, result);
 
-	common_free_splitted_string(disconnectedNodes, numDisconnectedNodes);
+	// Result holds disconnected node ids, each one followed by comma. Ids are looked up in place, without copying
+	disconnectedNodesCnt = common_str_count_tokens(result, ",") - 1;
+	node->disconnectedNodes = malloc(disconnectedNodesCnt * sizeof(Node*));
+	while (i < disconnectedNodesCnt && common_str_next_token(&rest, ",", &token))
+		node->disconnectedNodes[i++] = common_get_node_by_span(token.start, token.length);
 
-	node->disconnectedNodesCnt = numDisconnectedNodes - 1;
+	node->disconnectedNodesCnt = disconnectedNodesCnt;
 	node->isConditionMet = 1;
-	free(result);
 	return 0;
 }
 
 EXTERN_DLL_EXPORT Node** getNodesToExecute(Node* node, int* nodesToExecuteCnt)
 {
 	char* result = NULL;
-	coreclr_get_dynamic_nodes(*((int*)(node->implementationContext)), node, &result, IS_MANAGED);
+	const char* rest;
+	strSpan token;
+	int i = 0;
 
-	int numNodesToExecute = 0;
-	char **nodesToExecute = NULL;
-	common_str_split(result, ",", &numNodesToExecute, &nodesToExecute);
+	coreclr_get_dynamic_nodes(*((int*)(node->implementationContext)), node, &result, IS_MANAGED);
 
-	Node** disconnectedNodes = malloc((numNodesToExecute) * sizeof(Node*));
+	// Result holds node ids, each one followed by comma
+	*nodesToExecuteCnt = common_str_count_tokens(result, ",") - 1;
+	Node** disconnectedNodes = malloc((*nodesToExecuteCnt + 1) * sizeof(Node*));
 
-	common_parse_nodes(disconnectedNodes, nodesToExecute, numNodesToExecute - 1);
-	*nodesToExecuteCnt = numNodesToExecute - 1;
-	common_free_splitted_string(nodesToExecute, numNodesToExecute);
+	rest = result;
+	while (i < *nodesToExecuteCnt && common_str_next_token(&rest, ",", &token))
+		disconnectedNodes[i++] = common_get_node_by_span(token.start, token.length);
 	return disconnectedNodes;
 }
\ No newline at end of file
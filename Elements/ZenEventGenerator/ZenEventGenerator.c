@@ -0,0 +1,374 @@
+/*************************************************************************
+ * Copyright (c) 2015, 2018 Zenodys BV
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contributors:
+ *    Tomaž Vinko
+ *
+ **************************************************************************/
+
+/*=======================================================================================
+|
+|       Synthetic event generator, used for measuring event buffering throughput
+|
+|		  * PRODUCERS threads push events into node's event buffer, same as event Elements
+|			do from onNodeEvent. Event value is monotonic time of push.
+|		  * EVENTS_PER_SECOND limits rate of each producer, 0 means as fast as possible.
+|		  * When event is delivered to workflow, executeAction spends CONSUMER_COST_NS of
+|			busy work (emulated event processing).
+|		  * Latency is recorded in onNodeComplete, when trigger node (Sink) finishes and
+|			returns green light, so it covers whole push to end of processing path.
+|		  * Counters restart when engine ends warm up (common_stats_is_measuring), so
+|			results cover only measured time.
+|		  * On process exit, result of each node is printed as one line of JSON, prefixed
+|			with "EVENTS_RESULT " (see ZenBench events).
+|
++----------------------------------------------------------------------------------------
+|
+|   Known Bugs:		* none
+|
+*=======================================================================================*/
+
+#include "ZenEventGenerator.h"
+#include "ZenCommon.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#else
+#include <windows.h>
+#endif
+
+// Producer pushed events counter. Each one is on its own cache line, so producers don't share it
+typedef struct
+{
+	volatile uint64_t pushedCnt;
+	char padding[56];
+} producerCounter;
+
+typedef struct
+{
+	Node* node;
+	int producersCnt;
+	int eventsPerSecond;
+	int consumerCostNs;
+	producerCounter* producers;
+	// Start of measured time, and pushed and dropped events before it
+	uint64_t startNs;
+	uint64_t pushedBaseCnt;
+	int droppedBaseCnt;
+	int isMeasuring;
+	// Push to trigger node completion latency. Histogram count is number of processed events
+	latencyHistogram latency;
+} eventGeneratorContext;
+
+typedef struct
+{
+	eventGeneratorContext* context;
+	int producerIndex;
+} producerParams;
+
+// Interned property keys
+int _producersKey;
+int _eventsPerSecondKey;
+int _consumerCostKey;
+
+// Generator nodes, printed on exit
+eventGeneratorContext** _generators = NULL;
+int _generatorsCnt = 0;
+int _generatorsCapacity = 0;
+pthread_mutex_t _generators_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+* Sleeps producer thread
+*
+* @param ms		sleep time in milliseconds
+* @return		void
+*/
+void ProducerSleep(int ms)
+{
+#ifdef __linux__
+	usleep(ms * 1000);
+#else
+	Sleep(ms);
+#endif
+}
+
+/**
+* Producer thread. Pushes events until process exits
+*
+* @param params		producer params
+* @return			NULL
+*/
+void* ProduceEvents(void* params)
+{
+	eventGeneratorContext* context = ((producerParams*)params)->context;
+	producerCounter* counter = &context->producers[((producerParams*)params)->producerIndex];
+	uint64_t intervalNs = context->eventsPerSecond > 0 ? 1000000000ULL / context->eventsPerSecond : 0;
+	uint64_t nextNs = common_get_time_ns();
+
+	free(params);
+
+	while (1)
+	{
+		zen_value_t event = { 0 };
+		common_value_set_int(&event, (int64_t)common_get_time_ns());
+		common_push_value_to_buffer(context->node, &event);
+		counter->pushedCnt++;
+
+		if (intervalNs == 0)
+			continue;
+
+		nextNs += intervalNs;
+		while (common_get_time_ns() < nextNs)
+		{
+			if (nextNs - common_get_time_ns() > 2000000)
+				ProducerSleep(1);
+		}
+	}
+	return NULL;
+}
+
+/**
+* Spends given time with busy work, so that processing cost doesn't depend on scheduler
+*
+* @param costNs		busy work time
+* @return			void
+*/
+void ConsumeEvent(int costNs)
+{
+	uint64_t startNs;
+
+	if (costNs <= 0)
+		return;
+
+	startNs = common_get_time_ns();
+	while (common_get_time_ns() - startNs < (uint64_t)costNs)
+		;
+}
+
+/**
+* Returns number of events pushed by all producers of node
+*
+* @param context	generator context
+* @return			pushed events count
+*/
+uint64_t GetPushedCount(eventGeneratorContext* context)
+{
+	uint64_t pushedCnt = 0;
+	int i;
+
+	for (i = 0; i < context->producersCnt; i++)
+		pushedCnt += context->producers[i].pushedCnt;
+	return pushedCnt;
+}
+
+/**
+* Restarts counters at the end of engine warm up. Called from trigger node thread,
+* which is the only one that records latency
+*
+* @param context	generator context
+* @return			void
+*/
+void StartMeasurement(eventGeneratorContext* context)
+{
+	eventBufferStats bufferStats;
+
+	common_get_event_buffer_stats(context->node, &bufferStats);
+	context->droppedBaseCnt = bufferStats.droppedCnt;
+	context->pushedBaseCnt = GetPushedCount(context);
+	memset(&context->latency, 0, sizeof(latencyHistogram));
+	context->startNs = common_get_time_ns();
+	context->isMeasuring = 1;
+}
+
+/**
+* Processes one delivered event : emulates processing
+*
+* @param context	generator context
+* @param event		delivered event
+* @return			void
+*/
+void ProcessEvent(eventGeneratorContext* context, const zen_value_t* event)
+{
+	// First run of node is not triggered by event
+	if (event->as.intValue == 0)
+		return;
+
+	ConsumeEvent(context->consumerCostNs);
+}
+
+/**
+* Records latency of one processed event, from push to completion of trigger node
+*
+* @param context	generator context
+* @param event		processed event
+* @param nowNs		completion time
+* @return			void
+*/
+void RecordEventLatency(eventGeneratorContext* context, const zen_value_t* event, uint64_t nowNs)
+{
+	uint64_t pushedNs = (uint64_t)event->as.intValue;
+
+	if (pushedNs == 0)
+		return;
+
+	common_histogram_record(&context->latency, nowNs > pushedNs ? nowNs - pushedNs : 0);
+}
+
+/**
+* Prints results of all generator nodes as one line of JSON per node. Without engine warm up
+* (not in bench mode), results cover whole run
+*
+* @return	void
+*/
+void PrintEventGeneratorResults()
+{
+	int i, droppedCnt;
+	eventBufferStats bufferStats;
+	eventGeneratorContext* context;
+	uint64_t pushedCnt, durationNs;
+
+	pthread_mutex_lock(&_generators_lock);
+	for (i = 0; i < _generatorsCnt; i++)
+	{
+		context = _generators[i];
+		pushedCnt = GetPushedCount(context) - context->pushedBaseCnt;
+		durationNs = common_get_time_ns() - context->startNs;
+		common_get_event_buffer_stats(context->node, &bufferStats);
+		droppedCnt = bufferStats.droppedCnt - context->droppedBaseCnt;
+
+		printf("EVENTS_RESULT {\"node\":\"%s\",\"producers\":%d,\"bufferLength\":%d,\"consumerCostNs\":%d,\"durationNs\":%llu,"
+			"\"pushed\":%llu,\"dropped\":%d,\"processed\":%llu,\"pushedPerSec\":%.0f,\"processedPerSec\":%.0f,\"dropRate\":%.4f,"
+			"\"latencyAvgNs\":%llu,\"latencyP50Ns\":%llu,\"latencyP99Ns\":%llu,\"latencyP999Ns\":%llu,\"latencyMaxNs\":%llu,\"bufferHighWaterMark\":%d}\n",
+			context->node->id, context->producersCnt, bufferStats.maxSize, context->consumerCostNs, (unsigned long long)durationNs,
+			(unsigned long long)pushedCnt, droppedCnt, (unsigned long long)context->latency.cnt,
+			(double)pushedCnt * 1000000000.0 / (double)durationNs,
+			(double)context->latency.cnt * 1000000000.0 / (double)durationNs,
+			pushedCnt > 0 ? (double)droppedCnt / (double)pushedCnt : 0.0,
+			(unsigned long long)(context->latency.cnt > 0 ? context->latency.totalNs / context->latency.cnt : 0),
+			(unsigned long long)common_histogram_percentile(&context->latency, 50.0),
+			(unsigned long long)common_histogram_percentile(&context->latency, 99.0),
+			(unsigned long long)common_histogram_percentile(&context->latency, 99.9),
+			(unsigned long long)context->latency.maxNs,
+			bufferStats.highWaterMark);
+	}
+	fflush(stdout);
+	pthread_mutex_unlock(&_generators_lock);
+}
+
+EXTERN_DLL_EXPORT int onImplementationInit(char *params)
+{
+	_producersKey = common_intern_key("PRODUCERS");
+	_eventsPerSecondKey = common_intern_key("EVENTS_PER_SECOND");
+	_consumerCostKey = common_intern_key("CONSUMER_COST_NS");
+	atexit(PrintEventGeneratorResults);
+	return 0;
+}
+
+EXTERN_DLL_EXPORT int onSubscribeNodeToEvent(Node* node)
+{
+	eventGeneratorContext* context = calloc(1, sizeof(eventGeneratorContext));
+	context->node = node;
+	node->implementationContext = context;
+
+	pthread_mutex_lock(&_generators_lock);
+	if (_generatorsCnt == _generatorsCapacity)
+	{
+		_generatorsCapacity = _generatorsCapacity ? 2 * _generatorsCapacity : 16;
+		_generators = realloc(_generators, _generatorsCapacity * sizeof(eventGeneratorContext*));
+	}
+	_generators[_generatorsCnt++] = context;
+	pthread_mutex_unlock(&_generators_lock);
+	return 0;
+}
+
+EXTERN_DLL_EXPORT int onNodePreInit(Node* node)
+{
+	// Set once, before engine inits event buffer and events batch of this node
+	node->lastResult = NULL;
+	node->lastResultType = RESULT_TYPE_INT;
+	return 0;
+}
+
+EXTERN_DLL_EXPORT int onNodeInit(Node* node)
+{
+	eventGeneratorContext* context = node->implementationContext;
+	producerParams* params;
+	pthread_t thread;
+	int i;
+
+	context->producersCnt = common_get_node_arg_int(node, _producersKey);
+	if (context->producersCnt < 1)
+		context->producersCnt = 1;
+	context->eventsPerSecond = common_get_node_arg_int(node, _eventsPerSecondKey);
+	context->consumerCostNs = common_get_node_arg_int(node, _consumerCostKey);
+	context->producers = calloc(context->producersCnt, sizeof(producerCounter));
+	context->startNs = common_get_time_ns();
+
+	// Node is already event active here, so pushed events are not ignored
+	for (i = 0; i < context->producersCnt; i++)
+	{
+		params = malloc(sizeof(producerParams));
+		params->context = context;
+		params->producerIndex = i;
+		pthread_create(&thread, NULL, ProduceEvents, params);
+	}
+	return 0;
+}
+
+EXTERN_DLL_EXPORT int executeAction(Node *node)
+{
+	eventGeneratorContext* context = node->implementationContext;
+	eventsBatch* batch;
+	int i;
+
+	if (node->lastResultType == RESULT_TYPE_EVENTS_BATCH)
+	{
+		batch = (eventsBatch*)node->lastResult;
+		for (i = 0; i < batch->eventsCnt; i++)
+			ProcessEvent(context, &batch->events[i]);
+	}
+	else
+		ProcessEvent(context, common_result_get(node));
+
+	node->isConditionMet = 1;
+	return 0;
+}
+
+EXTERN_DLL_EXPORT int onNodeComplete(Node* node)
+{
+	eventGeneratorContext* context = node->implementationContext;
+	eventsBatch* batch;
+	uint64_t nowNs;
+	int i;
+
+	if (!context->isMeasuring && common_stats_is_measuring())
+		StartMeasurement(context);
+
+	// Delivered event is kept as node result until green light is returned after this call
+	nowNs = common_get_time_ns();
+	if (node->lastResultType == RESULT_TYPE_EVENTS_BATCH)
+	{
+		batch = (eventsBatch*)node->lastResult;
+		for (i = 0; i < batch->eventsCnt; i++)
+			RecordEventLatency(context, &batch->events[i], nowNs);
+	}
+	else
+		RecordEventLatency(context, common_result_get(node), nowNs);
+	return 0;
+}
@@ -26,33 +26,37 @@
 #include <stdio.h>
 #include <string.h>
 
-Node* _nodeIds[100];
+// Subscribed nodes. List grows as nodes subscribe
+Node** _nodeIds = NULL;
 int _nodeListCnt = 0;
+int _nodeListCapacity = 0;
 
 EXTERN_DLL_EXPORT int onSubscribeNodeToEvent(Node* node)
 {
-	_nodeIds[_nodeListCnt] = malloc(sizeof(Node));
-	_nodeIds[_nodeListCnt] = node;
-	_nodeListCnt++;
+	if (_nodeListCnt == _nodeListCapacity)
+	{
+		_nodeListCapacity = _nodeListCapacity ? 2 * _nodeListCapacity : 16;
+		_nodeIds = realloc(_nodeIds, _nodeListCapacity * sizeof(Node*));
+	}
+	_nodeIds[_nodeListCnt++] = node;
 	return 0;
 }
 
 EXTERN_DLL_EXPORT int onNodeEvent(Node* node, char* data)
 {
-	struct eventContextParamsStruct event_context;
+	zen_value_t event = { 0 };
 	((Node*)node)->isConditionMet = 1;
-	((Node*)node)->lastResultType = RESULT_TYPE_CHAR_ARRAY;
-	
-	event_context.data = (char*) malloc(sizeof(char));
-	strncpy((char*)event_context.data, data, strlen(data) + 1);
-	event_context.node = node;
-		
-	common_push_event_to_buffer(&event_context);
+
+	// Managed data is valid only during this call, so it's copied. Short strings stay inline, without heap allocation
+	common_value_set_string(&event, data);
+	common_push_value_to_buffer(node, &event);
 	return 0;
 }
 
 EXTERN_DLL_EXPORT int onNodePreInit(Node* node)
 {
+	// Set once, before engine inits event buffer and events batch of this node
+	node->lastResultType = RESULT_TYPE_CHAR_ARRAY;
 	coreclr_init_app_domain();
 	node->implementationContext = malloc(sizeof(int));
 	*((int*)(node->implementationContext)) = coreclr_create_delegates("ZenLicenceChecker", DOES_NOT_CONTAIN_DYN_ELEMENTS);
@@ -30,14 +30,18 @@
 #include <windows.h>
 #endif
 
+// Interned property keys
+int _sleepTimeKey;
+
 EXTERN_DLL_EXPORT int onImplementationInit(char *params)
 {
+	_sleepTimeKey = common_intern_key("SLEEP_TIME");
 	return 0;
 }
 
 EXTERN_DLL_EXPORT int executeAction(Node *node)
 {
-	int i = atoi(common_get_node_arg(node, "SLEEP_TIME"));
+	int i = common_get_node_arg_int(node, _sleepTimeKey);
 #ifdef __linux__
 	usleep(i * 1000);
 #else
@@ -0,0 +1,1252 @@
+/*************************************************************************
+ * Copyright (c) 2015, 2018 Zenodys BV
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contributors:
+ *    Tomaž Vinko
+ *   
+ **************************************************************************/
+
+/*=======================================================================================
+|
+|       Zen Engine micro-benchmarks
+|
+|		  * Each benchmark is selected by name from command line:
+|				ZenBench vtable <implementation library> [iterations]
+|
+|		  * vtable: compares resolving Element entry points with GetFunction (dlsym) on
+|			every node fire, against reading them from implementation vtable that
+|			is filled once in FillImplementationList.
+|
+|		  * layout: fires nodes of 1000 node graph, with node layout before hot/cold split
+|			(individually allocated nodes, pointer relations) and after it (contiguous
+|			nodes, scheduling arrays, CSR relations).
+|
+|		  * scenarios: synthesizes projects (linear chain, fan-out / fan-in with "&" and "||",
+|			many parallel loops) from native Elements and runs each of them in both execution
+|			modes, as separate engine process (ZenEngine --bench). Reports nodes/sec, hop
+|			latency and memory per node as JSON.
+|
+|		  * events: runs ZenEventGenerator Element (Start -> Generator -> Sink, Sink pulls buffered
+|			events) for each combination of producer threads, event buffer length and consumer
+|			cost. Reports pushed and processed events/sec, drop rate and push to processing
+|			latency as JSON.
+|
+|		  * results: one thread publishes node results (inline and heap strings), other threads
+|			take snapshots of them at the same time. Reports publishes/sec, snapshots/sec and
+|			number of torn snapshots, which must be zero.
+|
++----------------------------------------------------------------------------------------
+|
+|   Known Bugs:		* none
+|
+|	     To Do:		* none
+*==========================================================================================*/
+#include "ZenCommon.h"
+#include "os_call.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <direct.h>
+#else
+#include <unistd.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+#include <time.h>
+
+#define DEFAULT_ITERATIONS 10000000
+#define DEFAULT_LAYOUT_ROUNDS 2000
+#define LAYOUT_NODES_COUNT 1000
+#define LAYOUT_CHILDS_COUNT 4
+#define DEFAULT_SCENARIO_SECONDS 5
+#define DEFAULT_RESULTS_SECONDS 3
+#define DEFAULT_RESULTS_READERS 4
+// Published strings are 1 to RESULTS_MAX_LENGTH characters, so both inline and heap values are published
+#define RESULTS_MAX_LENGTH 200
+
+// Scenario projects are written here, each into its own directory
+#define BENCH_DIRECTORY "bench_projects"
+#define BENCH_PROJECT_ID "00000000-0000-0000-0000-00000000be4c"
+// Engine is killed if it doesn't finish in measurement time plus this
+#define BENCH_ENGINE_TIMEOUT_SECONDS 60
+// Engine prints result line with this prefix (see RunBench on engine)
+#define BENCH_RESULT_PREFIX "BENCH_RESULT "
+// ZenEventGenerator prints result line of each generator node with this prefix
+#define EVENTS_RESULT_PREFIX "EVENTS_RESULT "
+#define BENCH_RESULT_LENGTH 1024
+
+#if defined(_WIN32)
+#define BENCH_LIBRARY_EXTENSION ".dll"
+#else
+#define BENCH_LIBRARY_EXTENSION ".so"
+#endif
+
+// Results of benchmarked lookups are written here, so that compiler can't optimize them away
+volatile void* _sink;
+
+/**
+* Returns monotonic time in nanoseconds
+*
+* @return	time in nanoseconds
+*/
+long long GetTimeNs()
+{
+#if defined(_WIN32)
+	LARGE_INTEGER frequency, counter;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	return (long long)((double)counter.QuadPart * 1000000000.0 / frequency.QuadPart);
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#endif
+}
+
+//*************************************************************************/
+//************************ START VTABLE BENCHMARK *************************/
+//*************************************************************************/
+
+/**
+* Measures per fire cost of entry points lookup, that RunNodeInterfaces does on every node execution (onNodeInit and executeAction)
+*
+* @param	argc	number of benchmark arguments
+* @param	argv	benchmark arguments : implementation library path (without extension on linux) and optional number of iterations
+* @return	exit code
+*/
+int BenchVTable(int argc, char** argv)
+{
+	char libraryPath[MAX_PATH];
+	long long i, iterations, start, dlsymNs, vtableNs;
+	ImplementationVTable vtable;
+	ImplementationVTable* volatile ptrVTable = &vtable;
+
+	if (argc < 1)
+	{
+		fprintf(stderr, "Missing implementation library path\n");
+		return 1;
+	}
+
+	iterations = argc > 1 ? atoll(argv[1]) : DEFAULT_ITERATIONS;
+	snprintf(libraryPath, sizeof(libraryPath) - 4, "%s", argv[0]);
+	void* hDLL = LoadSharedLibrary(libraryPath);
+	if (hDLL == NULL)
+	{
+		fprintf(stderr, "Could not load implementation %s\n", libraryPath);
+		return 1;
+	}
+
+	// Same as FillImplementationVTable on engine
+	memset(&vtable, 0, sizeof(vtable));
+	vtable.onNodeInit = (ptrOnNodeInit)GetFunction(hDLL, "onNodeInit");
+	vtable.executeAction = (ptrExecuteAction)GetFunction(hDLL, "executeAction");
+
+	start = GetTimeNs();
+	for (i = 0; i < iterations; i++)
+	{
+		_sink = GetFunction(hDLL, "onNodeInit");
+		_sink = GetFunction(hDLL, "executeAction");
+	}
+	dlsymNs = GetTimeNs() - start;
+
+	start = GetTimeNs();
+	for (i = 0; i < iterations; i++)
+	{
+		_sink = (void*)ptrVTable->onNodeInit;
+		_sink = (void*)ptrVTable->executeAction;
+	}
+	vtableNs = GetTimeNs() - start;
+
+	printf("Implementation      : %s\n", libraryPath);
+	printf("Fires               : %lld\n", iterations);
+	printf("GetFunction lookups : %.2f ns/fire\n", (double)dlsymNs / iterations);
+	printf("VTable lookups      : %.2f ns/fire\n", (double)vtableNs / iterations);
+	printf("Saving              : %.2f ns/fire\n", (double)(dlsymNs - vtableNs) / iterations);
+
+	FreeSharedLibrary(hDLL);
+	return 0;
+}
+//*************************************************************************/
+//************************ END VTABLE BENCHMARK ***************************/
+//*************************************************************************/
+
+//*************************************************************************/
+//************************ START LAYOUT BENCHMARK *************************/
+//*************************************************************************/
+
+// Node layout before hot/cold split : scheduling fields are mixed with cold data, nodes are
+// allocated one by one and relations are separately allocated pointer arrays
+typedef struct legacyNode
+{
+	char id[50];
+	char implementationId[50];
+	int isEventActive;
+	void* implementation;
+	void* vtable;
+	int trueParentsCnt;
+	int falseParentsCnt;
+	int trueChildsCnt;
+	int falseChildsCnt;
+	int disconnectedNodesCnt;
+	void** args;
+	int argsCnt;
+	int isStarted;
+	volatile int status;
+	struct legacyNode** ptrTrueChilds;
+	struct legacyNode** ptrFalseChilds;
+	struct legacyNode** ptrTrueParents;
+	struct legacyNode** ptrFalseParents;
+	void* disconnectedNodes;
+	int isConditionMet;
+	int nodeOperator;
+	time_t started;
+	int unregisterEvent;
+	int errorCode;
+	char errorMessage[512];
+	void* implementationContext;
+	int isInitialized;
+	void** lastResult;
+	int lastResultType;
+	zen_value_t resultSlots[2];
+	volatile unsigned resultSequence;
+	volatile int resultReadersCnt;
+	void* nodesToTrigger;
+	int nodesToTriggerCnt;
+	buffer_t bufferedEvents;
+	void* batchedEvents;
+	int isActionable;
+	int loopLockId;
+	int nodeLockId;
+	int pauseNodeConditionId;
+	int eventQueueLockId;
+	volatile int hasGreenLight;
+	int isQueued;
+	void* nextQueued;
+	int runningWaitsCnt;
+	volatile int statusWaitersCnt;
+	volatile int satisfiedParentsCnt;
+	int requiredParentsCnt;
+	int publishedConditionMet;
+} legacyNode;
+
+// Node layout after hot/cold split
+typedef struct
+{
+	Node* nodes;
+	volatile int* satisfiedParentsCnt;
+	int* requiredParentsCnt;
+	uint32_t* childRows;
+	uint32_t* childs;
+	uint32_t* parentRows;
+	uint32_t* parents;
+} layoutGraph;
+
+unsigned int _layout_seed = 12345;
+
+/**
+* Returns pseudo random number, same sequence on all platforms
+*
+* @return	random number
+*/
+unsigned int LayoutRandom()
+{
+	_layout_seed = _layout_seed * 1103515245 + 12345;
+	return (_layout_seed >> 16) & 0x7fff;
+}
+
+/**
+* Fires node with legacy layout : publishes flipped condition to childs, checks childs readiness
+* and parents status, same as OnNodeFinish did
+*
+* @param	node	fired node
+* @return	number of ready childs and running parents
+*/
+int FireLegacyNode(legacyNode* node)
+{
+	int i, delta, readyCnt = 0;
+
+	node->isConditionMet = !node->isConditionMet;
+	node->publishedConditionMet = node->isConditionMet;
+	delta = node->isConditionMet ? 1 : -1;
+
+	for (i = 0; i < node->trueChildsCnt; i++)
+		ATOMIC_ADD(&node->ptrTrueChilds[i]->satisfiedParentsCnt, delta);
+
+	for (i = 0; i < node->trueChildsCnt; i++)
+		if (ATOMIC_LOAD(&node->ptrTrueChilds[i]->satisfiedParentsCnt) >= node->ptrTrueChilds[i]->requiredParentsCnt)
+			readyCnt++;
+
+	for (i = 0; i < node->trueParentsCnt; i++)
+		if (ATOMIC_LOAD(&node->ptrTrueParents[i]->status) != NODE_STATUS_STOPPED)
+			readyCnt++;
+	return readyCnt;
+}
+
+/**
+* Fires node with hot/cold split layout. Same work as FireLegacyNode
+*
+* @param	graph	nodes, scheduling arrays and relations
+* @param	index	index of fired node
+* @return	number of ready childs and running parents
+*/
+int FireNode(layoutGraph* graph, uint32_t index)
+{
+	Node* node = &graph->nodes[index];
+	int i, delta, readyCnt = 0;
+
+	node->isConditionMet = !node->isConditionMet;
+	node->publishedConditionMet = node->isConditionMet;
+	delta = node->isConditionMet ? 1 : -1;
+
+	for (i = 0; i < node->trueChildsCnt; i++)
+		ATOMIC_ADD(&graph->satisfiedParentsCnt[node->trueChilds[i]], delta);
+
+	for (i = 0; i < node->trueChildsCnt; i++)
+		if (ATOMIC_LOAD(&graph->satisfiedParentsCnt[node->trueChilds[i]]) >= graph->requiredParentsCnt[node->trueChilds[i]])
+			readyCnt++;
+
+	for (i = 0; i < node->trueParentsCnt; i++)
+		if (ATOMIC_LOAD(&graph->nodes[node->trueParents[i]].status) != NODE_STATUS_STOPPED)
+			readyCnt++;
+	return readyCnt;
+}
+
+/**
+* Measures node fire cost on 1000 node graph, before and after hot/cold split of Node.
+* Both layouts get the same random graph and the same random fire order
+*
+* @param	argc	number of benchmark arguments
+* @param	argv	benchmark arguments : optional number of rounds (each round fires all nodes)
+* @return	exit code
+*/
+int BenchLayout(int argc, char** argv)
+{
+	long long start, legacyNs, layoutNs, rounds, round, fires;
+	long long legacyReadyCnt = 0, layoutReadyCnt = 0;
+	uint32_t i, j, tmp;
+	uint32_t* childs = malloc(LAYOUT_NODES_COUNT * LAYOUT_CHILDS_COUNT * sizeof(uint32_t));
+	uint32_t* fireOrder = malloc(LAYOUT_NODES_COUNT * sizeof(uint32_t));
+	legacyNode** legacyNodes = malloc(LAYOUT_NODES_COUNT * sizeof(legacyNode*));
+	layoutGraph graph;
+
+	rounds = argc > 0 ? atoll(argv[0]) : DEFAULT_LAYOUT_ROUNDS;
+
+	// Random graph and fire order
+	for (i = 0; i < LAYOUT_NODES_COUNT * LAYOUT_CHILDS_COUNT; i++)
+		childs[i] = (LayoutRandom() * 32768 + LayoutRandom()) % LAYOUT_NODES_COUNT;
+	for (i = 0; i < LAYOUT_NODES_COUNT; i++)
+		fireOrder[i] = i;
+	for (i = LAYOUT_NODES_COUNT - 1; i > 0; i--)
+	{
+		j = (LayoutRandom() * 32768 + LayoutRandom()) % (i + 1);
+		tmp = fireOrder[i];
+		fireOrder[i] = fireOrder[j];
+		fireOrder[j] = tmp;
+	}
+
+	// Legacy layout : nodes are allocated one by one, with node args in between, as FillNodeList did.
+	// Parent arrays grow with realloc per relation, as FillRelationList did
+	for (i = 0; i < LAYOUT_NODES_COUNT; i++)
+	{
+		legacyNodes[i] = calloc(1, sizeof(legacyNode));
+		legacyNodes[i]->argsCnt = 3;
+		legacyNodes[i]->args = malloc(legacyNodes[i]->argsCnt * sizeof(void*));
+		for (j = 0; j < (uint32_t)legacyNodes[i]->argsCnt; j++)
+			legacyNodes[i]->args[j] = malloc(64);
+		legacyNodes[i]->status = NODE_STATUS_STOPPED;
+		legacyNodes[i]->requiredParentsCnt = 1;
+	}
+	for (i = 0; i < LAYOUT_NODES_COUNT; i++)
+	{
+		legacyNodes[i]->ptrTrueChilds = malloc(LAYOUT_CHILDS_COUNT * sizeof(legacyNode*));
+		legacyNodes[i]->trueChildsCnt = LAYOUT_CHILDS_COUNT;
+		for (j = 0; j < LAYOUT_CHILDS_COUNT; j++)
+		{
+			legacyNode* childNode = legacyNodes[childs[i * LAYOUT_CHILDS_COUNT + j]];
+			legacyNodes[i]->ptrTrueChilds[j] = childNode;
+			childNode->ptrTrueParents = realloc(childNode->ptrTrueParents, (childNode->trueParentsCnt + 1) * sizeof(legacyNode*));
+			childNode->ptrTrueParents[childNode->trueParentsCnt++] = legacyNodes[i];
+		}
+	}
+
+	// Hot/cold split layout : contiguous nodes, scheduling arrays and CSR relations
+	graph.nodes = calloc(LAYOUT_NODES_COUNT, sizeof(Node));
+	graph.satisfiedParentsCnt = calloc(LAYOUT_NODES_COUNT, sizeof(int));
+	graph.requiredParentsCnt = calloc(LAYOUT_NODES_COUNT, sizeof(int));
+	graph.childRows = malloc((LAYOUT_NODES_COUNT + 1) * sizeof(uint32_t));
+	graph.childs = childs;
+	graph.parentRows = calloc(LAYOUT_NODES_COUNT + 2, sizeof(uint32_t));
+	graph.parents = malloc(LAYOUT_NODES_COUNT * LAYOUT_CHILDS_COUNT * sizeof(uint32_t));
+	for (i = 0; i <= LAYOUT_NODES_COUNT; i++)
+		graph.childRows[i] = i * LAYOUT_CHILDS_COUNT;
+	for (i = 0; i < LAYOUT_NODES_COUNT * LAYOUT_CHILDS_COUNT; i++)
+		graph.parentRows[childs[i] + 2]++;
+	for (i = 2; i < LAYOUT_NODES_COUNT + 2; i++)
+		graph.parentRows[i] += graph.parentRows[i - 1];
+	for (i = 0; i < LAYOUT_NODES_COUNT; i++)
+		for (j = graph.childRows[i]; j < graph.childRows[i + 1]; j++)
+			graph.parents[graph.parentRows[childs[j] + 1]++] = i;
+	for (i = 0; i < LAYOUT_NODES_COUNT; i++)
+	{
+		graph.nodes[i].index = i;
+		graph.nodes[i].status = NODE_STATUS_STOPPED;
+		graph.nodes[i].trueChilds = &graph.childs[graph.childRows[i]];
+		graph.nodes[i].trueChildsCnt = LAYOUT_CHILDS_COUNT;
+		graph.nodes[i].trueParents = &graph.parents[graph.parentRows[i]];
+		graph.nodes[i].trueParentsCnt = graph.parentRows[i + 1] - graph.parentRows[i];
+		graph.requiredParentsCnt[i] = 1;
+	}
+
+	start = GetTimeNs();
+	for (round = 0; round < rounds; round++)
+		for (i = 0; i < LAYOUT_NODES_COUNT; i++)
+			legacyReadyCnt += FireLegacyNode(legacyNodes[fireOrder[i]]);
+	legacyNs = GetTimeNs() - start;
+
+	start = GetTimeNs();
+	for (round = 0; round < rounds; round++)
+		for (i = 0; i < LAYOUT_NODES_COUNT; i++)
+			layoutReadyCnt += FireNode(&graph, fireOrder[i]);
+	layoutNs = GetTimeNs() - start;
+
+	fires = rounds * LAYOUT_NODES_COUNT;
+	printf("Nodes               : %d (%d childs each)\n", LAYOUT_NODES_COUNT, LAYOUT_CHILDS_COUNT);
+	printf("Fires               : %lld\n", fires);
+	printf("Node size           : %d bytes before, %d bytes after\n", (int)sizeof(legacyNode), (int)sizeof(Node));
+	printf("Before split        : %.2f ns/fire\n", (double)legacyNs / fires);
+	printf("After split         : %.2f ns/fire\n", (double)layoutNs / fires);
+	printf("Speedup             : %.2fx\n", layoutNs > 0 ? (double)legacyNs / layoutNs : 0.0);
+	if (legacyReadyCnt != layoutReadyCnt)
+		fprintf(stderr, "Layouts disagree : %lld ready before, %lld after\n", legacyReadyCnt, layoutReadyCnt);
+
+	for (i = 0; i < LAYOUT_NODES_COUNT; i++)
+	{
+		for (j = 0; j < (uint32_t)legacyNodes[i]->argsCnt; j++)
+			free(legacyNodes[i]->args[j]);
+		free(legacyNodes[i]->args);
+		free(legacyNodes[i]->ptrTrueChilds);
+		free(legacyNodes[i]->ptrTrueParents);
+		free(legacyNodes[i]);
+	}
+	free(legacyNodes);
+	free(graph.nodes);
+	free((void*)graph.satisfiedParentsCnt);
+	free(graph.requiredParentsCnt);
+	free(graph.childRows);
+	free(graph.parentRows);
+	free(graph.parents);
+	free(childs);
+	free(fireOrder);
+	return legacyReadyCnt == layoutReadyCnt ? 0 : 1;
+}
+//*************************************************************************/
+//************************ END LAYOUT BENCHMARK ***************************/
+//*************************************************************************/
+
+//*************************************************************************/
+//************************ START SCENARIO BENCHMARK ***********************/
+//*************************************************************************/
+
+// Writes nodes (Modules.zen content) and relations (Relations.zen content) of scenario project with given number of nodes
+typedef void(*ptrWriteScenario)(FILE* modules, FILE* relations, int size);
+
+typedef struct
+{
+	const char* name;
+	int size;
+	ptrWriteScenario writeScenario;
+} benchScenario;
+
+// Element, copied into bench project
+typedef struct
+{
+	const char* name;
+	// Implementation type ("ACTION" or event type)
+	const char* type;
+} benchElement;
+
+/**
+* Writes one node to Modules.zen. Pass-through nodes are inactive "Start" nodes, which only set condition to true
+*
+* @param	modules			Modules.zen file
+* @param	name			node name
+* @param	nodeOperator	node operator ("&" or "||")
+* @param	isActive		1 for loop entry "Start" node, 0 for pass-through node
+* @param	isFirst			1 if it's first node in file
+* @return	void
+*/
+void WriteScenarioNode(FILE* modules, const char* name, const char* nodeOperator, int isActive, int isFirst)
+{
+	fprintf(modules, "%s\"%s\":{\"IMPLEMENTATION\":\"ZenStart#0#\",\"OPERATOR\":\"%s\",\"ELEMENT_PROPERTIES\":{\"ACTIVE\":\"%d\"},\"ELEMENT_NAME\":\"%s\"}",
+		isFirst ? "" : ",", name, nodeOperator, isActive, name);
+}
+
+/**
+* Linear chain : Start -> N1 -> N2 -> ... -> Start. Measures scheduling cost of one hop
+*/
+void WriteChainScenario(FILE* modules, FILE* relations, int size)
+{
+	int i;
+
+	WriteScenarioNode(modules, "Start", "||", 1, 1);
+	fprintf(relations, "Start,N1,;");
+	for (i = 1; i < size; i++)
+	{
+		char name[NODE_ID_LENGTH];
+		snprintf(name, sizeof(name), "N%d", i);
+		WriteScenarioNode(modules, name, "||", 0, 0);
+		if (i < size - 1)
+			fprintf(relations, "N%d,N%d,;", i, i + 1);
+		else
+			fprintf(relations, "N%d,Start,;", i);
+	}
+}
+
+/**
+* Fan-out / fan-in : Start -> N1 | N2 | ... -> Join -> Start, with given operator of Join node
+*/
+void WriteFanScenario(FILE* modules, FILE* relations, int size, const char* joinOperator)
+{
+	int i;
+
+	WriteScenarioNode(modules, "Start", "||", 1, 1);
+	WriteScenarioNode(modules, "Join", joinOperator, 0, 0);
+	fprintf(relations, "Start,");
+	for (i = 1; i < size - 1; i++)
+		fprintf(relations, "%sN%d", i > 1 ? "|" : "", i);
+	fprintf(relations, ",;");
+
+	for (i = 1; i < size - 1; i++)
+	{
+		char name[NODE_ID_LENGTH];
+		snprintf(name, sizeof(name), "N%d", i);
+		WriteScenarioNode(modules, name, "||", 0, 0);
+		fprintf(relations, "N%d,Join,;", i);
+	}
+	fprintf(relations, "Join,Start,;");
+}
+
+/**
+* Fan-in with "&" : Join waits for all parents
+*/
+void WriteFanAndScenario(FILE* modules, FILE* relations, int size)
+{
+	WriteFanScenario(modules, relations, size, "&");
+}
+
+/**
+* Fan-in with "||" : Join starts when any parent finishes
+*/
+void WriteFanOrScenario(FILE* modules, FILE* relations, int size)
+{
+	WriteFanScenario(modules, relations, size, "||");
+}
+
+/**
+* Many independent loops : Start1 -> N1 -> Start1, Start2 -> N2 -> Start2 ...
+*/
+void WriteParallelLoopsScenario(FILE* modules, FILE* relations, int size)
+{
+	int i;
+
+	for (i = 0; i < size / 2; i++)
+	{
+		char name[NODE_ID_LENGTH];
+		snprintf(name, sizeof(name), "Start%d", i);
+		WriteScenarioNode(modules, name, "||", 1, i == 0);
+		snprintf(name, sizeof(name), "N%d", i);
+		WriteScenarioNode(modules, name, "||", 0, 0);
+		fprintf(relations, "Start%d,N%d,;N%d,Start%d,;", i, i, i, i);
+	}
+}
+
+benchScenario _scenarios[] =
+{
+	{ "chain", 1000, WriteChainScenario },
+	{ "fan_and", 256, WriteFanAndScenario },
+	{ "fan_or", 256, WriteFanOrScenario },
+	{ "parallel_loops", 256, WriteParallelLoopsScenario },
+};
+
+const char* _scenario_modes[] = { "Threads", "Pool" };
+
+benchElement _scenario_elements[] = { { "ZenStart", "ACTION" } };
+benchElement _events_elements[] = { { "ZenStart", "ACTION" }, { "ZenEventGenerator", "EVENT" } };
+
+// Events benchmark sweep
+int _events_producers[] = { 1, 2, 4 };
+int _events_buffer_lengths[] = { 16, 1024, 65536 };
+int _events_consumer_costs[] = { 0, 1000, 10000 };
+
+/**
+* Creates directory. Existing directory is not an error
+*
+* @param	path	directory path
+* @return	void
+*/
+void MakeBenchDirectory(const char* path)
+{
+#if defined(_WIN32)
+	_mkdir(path);
+#else
+	mkdir(path, 0755);
+#endif
+}
+
+/**
+* Copies file
+*
+* @param	source		source file path
+* @param	destination	destination file path
+* @return	0 on success
+*/
+int CopyBenchFile(const char* source, const char* destination)
+{
+	char buffer[65536];
+	size_t readCnt;
+	FILE* in = fopen(source, "rb");
+	FILE* out;
+
+	if (in == NULL)
+		return 1;
+	out = fopen(destination, "wb");
+	if (out == NULL)
+	{
+		fclose(in);
+		return 1;
+	}
+
+	while ((readCnt = fread(buffer, 1, sizeof(buffer), in)) > 0)
+		fwrite(buffer, 1, readCnt, out);
+
+	fclose(in);
+	fclose(out);
+	return 0;
+}
+
+/**
+* Writes bench project into directory, in same structure as engine expects it (project/<project id>/...).
+* Elements are copied from Elements directory. Caller writes nodes and relations into returned files
+*
+* @param	directory		bench project directory
+* @param	mode			engine execution mode
+* @param	elementsPath	directory with built native Elements
+* @param	elements		Elements of project
+* @param	elementsCnt		number of Elements
+* @param	modules			Modules.zen file (output argument)
+* @param	relations		Relations.zen file (output argument)
+* @return	0 on success
+*/
+int WriteBenchProject(const char* directory, const char* mode, const char* elementsPath, const benchElement* elements, int elementsCnt, FILE** modules, FILE** relations)
+{
+	char path[MAX_PATH];
+	char source[MAX_PATH];
+	FILE* file;
+	int i;
+
+	MakeBenchDirectory(directory);
+	snprintf(path, sizeof(path), "%s/project", directory);
+	MakeBenchDirectory(path);
+	snprintf(path, sizeof(path), "%s/project/%s", directory, BENCH_PROJECT_ID);
+	MakeBenchDirectory(path);
+	snprintf(path, sizeof(path), "%s/project/%s/DB", directory, BENCH_PROJECT_ID);
+	MakeBenchDirectory(path);
+	snprintf(path, sizeof(path), "%s/project/%s/Implementations", directory, BENCH_PROJECT_ID);
+	MakeBenchDirectory(path);
+
+	for (i = 0; i < elementsCnt; i++)
+	{
+		snprintf(source, sizeof(source), "%s/%s%s", elementsPath, elements[i].name, BENCH_LIBRARY_EXTENSION);
+		snprintf(path, sizeof(path), "%s/project/%s/Implementations/%s%s", directory, BENCH_PROJECT_ID, elements[i].name, BENCH_LIBRARY_EXTENSION);
+		if (CopyBenchFile(source, path) != 0)
+		{
+			fprintf(stderr, "Could not copy %s\n", source);
+			return 1;
+		}
+	}
+
+	snprintf(path, sizeof(path), "%s/project/%s/Settings.ini", directory, BENCH_PROJECT_ID);
+	file = fopen(path, "w");
+	if (file == NULL)
+		return 1;
+	fprintf(file, "[Engine]\nExecutionMode = %s\nWorkers = 0\n[Mqtt]\nHost =\nPort =\n[Elements]\nVersion = 2.0.0\n[Template]\nID =\nWorkstationID =\nWorkstationName = ZenBench\nKey =\n", mode);
+	fclose(file);
+
+	snprintf(path, sizeof(path), "%s/project/%s/DB/Implementations.zen", directory, BENCH_PROJECT_ID);
+	file = fopen(path, "w");
+	if (file == NULL)
+		return 1;
+	for (i = 0; i < elementsCnt; i++)
+		fprintf(file, "%s,%s#0#,%s,0,,;", elements[i].name, elements[i].name, elements[i].type);
+	fclose(file);
+
+	snprintf(path, sizeof(path), "%s/project/%s/DB/Modules.zen", directory, BENCH_PROJECT_ID);
+	*modules = fopen(path, "w");
+	snprintf(path, sizeof(path), "%s/project/%s/DB/Relations.zen", directory, BENCH_PROJECT_ID);
+	*relations = fopen(path, "w");
+	if (*modules == NULL || *relations == NULL)
+	{
+		if (*modules != NULL)
+			fclose(*modules);
+		if (*relations != NULL)
+			fclose(*relations);
+		return 1;
+	}
+	return 0;
+}
+
+/**
+* Writes scenario project into directory
+*
+* @param	directory		scenario directory
+* @param	scenario		scenario
+* @param	mode			engine execution mode
+* @param	elementsPath	directory with built native Elements
+* @return	0 on success
+*/
+int WriteScenarioProject(const char* directory, benchScenario* scenario, const char* mode, const char* elementsPath)
+{
+	FILE* modules;
+	FILE* relations;
+
+	if (WriteBenchProject(directory, mode, elementsPath, _scenario_elements, sizeof(_scenario_elements) / sizeof(_scenario_elements[0]), &modules, &relations) != 0)
+		return 1;
+
+	fprintf(modules, "{");
+	scenario->writeScenario(modules, relations, scenario->size);
+	fprintf(modules, "}");
+	fclose(modules);
+	fclose(relations);
+	return 0;
+}
+
+/**
+* Writes events project into directory : Start -> Generator -> Sink. Sink is trigger node of Generator,
+* so next buffered event is delivered when Sink finishes
+*
+* @param	directory		events run directory
+* @param	elementsPath	directory with built native Elements
+* @param	producersCnt	number of producer threads
+* @param	bufferLength	event buffer length
+* @param	consumerCostNs	processing cost of each event
+* @return	0 on success
+*/
+int WriteEventsProject(const char* directory, const char* elementsPath, int producersCnt, int bufferLength, int consumerCostNs)
+{
+	FILE* modules;
+	FILE* relations;
+
+	if (WriteBenchProject(directory, "Threads", elementsPath, _events_elements, sizeof(_events_elements) / sizeof(_events_elements[0]), &modules, &relations) != 0)
+		return 1;
+
+	fprintf(modules, "{");
+	WriteScenarioNode(modules, "Start", "||", 1, 1);
+	WriteScenarioNode(modules, "Sink", "||", 0, 0);
+	fprintf(modules, ",\"Generator\":{\"IMPLEMENTATION\":\"ZenEventGenerator#0#\",\"OPERATOR\":\"||\",\"ELEMENT_PROPERTIES\":{\"PRODUCERS\":\"%d\",\"EVENTS_PER_SECOND\":\"0\","
+		"\"CONSUMER_COST_NS\":\"%d\",\"__BUFFER_TRIGGERS__\":\"Sink\",\"__EVENTS_BUFFER_LENGTH__\":\"%d\"},\"ELEMENT_NAME\":\"Generator\"}}",
+		producersCnt, consumerCostNs, bufferLength);
+	fprintf(relations, "Start,Generator,;Generator,Sink,;");
+	fclose(modules);
+	fclose(relations);
+	return 0;
+}
+
+/**
+* Runs engine in bench mode as child process in scenario directory. Engine output is written to engine.log
+*
+* @param	enginePath	absolute path of engine executable
+* @param	directory	scenario directory
+* @param	seconds		measurement time
+* @return	0 on success
+*/
+int RunBenchEngine(const char* enginePath, const char* directory, int seconds)
+{
+	char logPath[MAX_PATH];
+	char secondsArg[16];
+	int timeoutMs = (seconds + BENCH_ENGINE_TIMEOUT_SECONDS) * 1000;
+
+	snprintf(logPath, sizeof(logPath), "%s/engine.log", directory);
+	snprintf(secondsArg, sizeof(secondsArg), "%d", seconds);
+
+#if defined(_WIN32)
+	char commandLine[MAX_PATH + 32];
+	SECURITY_ATTRIBUTES attributes = { sizeof(SECURITY_ATTRIBUTES), NULL, TRUE };
+	STARTUPINFOA startupInfo;
+	PROCESS_INFORMATION processInfo;
+	HANDLE log = CreateFileA(logPath, GENERIC_WRITE, FILE_SHARE_READ, &attributes, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	DWORD exitCode = 1;
+
+	if (log == INVALID_HANDLE_VALUE)
+		return 1;
+
+	snprintf(commandLine, sizeof(commandLine), "\"%s\" --bench %s", enginePath, secondsArg);
+	memset(&startupInfo, 0, sizeof(startupInfo));
+	startupInfo.cb = sizeof(startupInfo);
+	startupInfo.dwFlags = STARTF_USESTDHANDLES;
+	startupInfo.hStdInput = NULL;
+	startupInfo.hStdOutput = log;
+	startupInfo.hStdError = log;
+
+	if (!CreateProcessA(NULL, commandLine, NULL, NULL, TRUE, 0, NULL, directory, &startupInfo, &processInfo))
+	{
+		CloseHandle(log);
+		return 1;
+	}
+
+	if (WaitForSingleObject(processInfo.hProcess, timeoutMs) == WAIT_TIMEOUT)
+		TerminateProcess(processInfo.hProcess, 1);
+	GetExitCodeProcess(processInfo.hProcess, &exitCode);
+	CloseHandle(processInfo.hThread);
+	CloseHandle(processInfo.hProcess);
+	CloseHandle(log);
+	return exitCode != 0;
+#else
+	int status;
+	int waitedMs;
+	pid_t pid = fork();
+
+	if (pid < 0)
+		return 1;
+
+	if (pid == 0)
+	{
+		if (chdir(directory) != 0 || freopen("engine.log", "w", stdout) == NULL || freopen("/dev/null", "r", stdin) == NULL)
+			_exit(1);
+		dup2(fileno(stdout), fileno(stderr));
+		execl(enginePath, enginePath, "--bench", secondsArg, (char*)NULL);
+		_exit(1);
+	}
+
+	for (waitedMs = 0; waitpid(pid, &status, WNOHANG) == 0; waitedMs += 100)
+	{
+		if (waitedMs >= timeoutMs)
+		{
+			kill(pid, SIGKILL);
+			waitpid(pid, &status, 0);
+			return 1;
+		}
+		usleep(100000);
+	}
+	return !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+#endif
+}
+
+/**
+* Reads result line with given prefix from engine.log of scenario. If there are more such lines, last one is returned
+*
+* @param	directory	scenario directory
+* @param	prefix		result line prefix
+* @param	result		result JSON object (output argument)
+* @param	resultSize	size of result buffer
+* @return	0 on success
+*/
+int ReadBenchResult(const char* directory, const char* prefix, char* result, int resultSize)
+{
+	char path[MAX_PATH];
+	char line[BENCH_RESULT_LENGTH];
+	int isFound = 0;
+	FILE* log;
+
+	snprintf(path, sizeof(path), "%s/engine.log", directory);
+	log = fopen(path, "r");
+	if (log == NULL)
+		return 1;
+
+	while (fgets(line, sizeof(line), log) != NULL)
+	{
+		if (strncmp(line, prefix, strlen(prefix)) == 0)
+		{
+			snprintf(result, resultSize, "%s", line + strlen(prefix));
+			result[strcspn(result, "\r\n")] = '\0';
+			isFound = 1;
+		}
+	}
+	fclose(log);
+	return !isFound;
+}
+
+/**
+* Returns number field of JSON object. Result objects are flat, so field is found by name
+*
+* @param	json	JSON object
+* @param	field	field name
+* @return	field value, 0 if field doesn't exist
+*/
+double GetBenchResultField(const char* json, const char* field)
+{
+	char key[64];
+	const char* position;
+
+	snprintf(key, sizeof(key), "\"%s\":", field);
+	position = strstr(json, key);
+	return position == NULL ? 0 : atof(position + strlen(key));
+}
+
+// State of benchmark, that runs series of projects as separate engine processes and collects their results into one JSON document
+typedef struct
+{
+	char enginePath[MAX_PATH];
+	const char* elementsPath;
+	int seconds;
+	FILE* output;
+	int isFirst;
+	int failedCnt;
+} benchRuns;
+
+/**
+* Parses arguments of engine benchmark, opens output and starts JSON document
+*
+* @param	runs	benchmark state (output argument)
+* @param	argc	number of benchmark arguments
+* @param	argv	benchmark arguments : engine executable, Elements directory, optional seconds per run and optional JSON output file
+* @return	0 on success
+*/
+int BeginBenchRuns(benchRuns* runs, int argc, char** argv)
+{
+	memset(runs, 0, sizeof(benchRuns));
+	runs->output = stdout;
+	runs->isFirst = 1;
+
+	if (argc < 2)
+	{
+		fprintf(stderr, "Missing engine executable or Elements directory\n");
+		return 1;
+	}
+
+#if defined(_WIN32)
+	if (_fullpath(runs->enginePath, argv[0], sizeof(runs->enginePath)) == NULL)
+#else
+	if (realpath(argv[0], runs->enginePath) == NULL)
+#endif
+	{
+		fprintf(stderr, "Engine %s not found\n", argv[0]);
+		return 1;
+	}
+
+	runs->elementsPath = argv[1];
+	runs->seconds = argc > 2 ? atoi(argv[2]) : DEFAULT_SCENARIO_SECONDS;
+	if (argc > 3)
+	{
+		runs->output = fopen(argv[3], "w");
+		if (runs->output == NULL)
+		{
+			fprintf(stderr, "Could not open %s\n", argv[3]);
+			return 1;
+		}
+	}
+
+	MakeBenchDirectory(BENCH_DIRECTORY);
+	fprintf(runs->output, "{\"seconds\":%d,\"results\":[", runs->seconds);
+	return 0;
+}
+
+/**
+* Counts failed run and reports it to standard error
+*
+* @param	runs		benchmark state
+* @param	label		run label
+* @param	directory	run directory
+* @return	void
+*/
+void FailBenchRun(benchRuns* runs, const char* label, const char* directory)
+{
+	fprintf(stderr, "%s : failed, see %s/engine.log\n", label, directory);
+	runs->failedCnt++;
+}
+
+/**
+* Runs written project in engine process and appends its result to JSON document
+*
+* @param	runs		benchmark state
+* @param	directory	run directory
+* @param	prefix		result line prefix
+* @param	label		run label, used in failure report
+* @param	parameters	JSON fields, that describe run
+* @param	result		result JSON object (output argument)
+* @param	resultSize	size of result buffer
+* @return	0 on success
+*/
+int RunBenchProject(benchRuns* runs, const char* directory, const char* prefix, const char* label, const char* parameters, char* result, int resultSize)
+{
+	if (RunBenchEngine(runs->enginePath, directory, runs->seconds) != 0
+		|| ReadBenchResult(directory, prefix, result, resultSize) != 0)
+	{
+		FailBenchRun(runs, label, directory);
+		return 1;
+	}
+
+	fprintf(runs->output, "%s\n{%s,\"result\":%s}", runs->isFirst ? "" : ",", parameters, result);
+	runs->isFirst = 0;
+	return 0;
+}
+
+/**
+* Ends JSON document and closes output
+*
+* @param	runs	benchmark state
+* @return	exit code
+*/
+int EndBenchRuns(benchRuns* runs)
+{
+	fprintf(runs->output, "\n]}\n");
+	if (runs->output != stdout)
+		fclose(runs->output);
+	return runs->failedCnt > 0;
+}
+
+/**
+* Runs each scenario in each execution mode. Every run is separate engine process, so that runs don't
+* affect each other. Results are written as JSON (to file or standard output), summary to standard error
+*
+* @param	argc	number of benchmark arguments
+* @param	argv	benchmark arguments : engine executable, Elements directory, optional seconds per run and optional JSON output file
+* @return	exit code
+*/
+int BenchScenarios(int argc, char** argv)
+{
+	benchRuns runs;
+	char directory[MAX_PATH];
+	char label[64];
+	char parameters[256];
+	char result[BENCH_RESULT_LENGTH];
+	int i, j;
+
+	if (BeginBenchRuns(&runs, argc, argv) != 0)
+		return 1;
+
+	for (i = 0; i < (int)(sizeof(_scenarios) / sizeof(_scenarios[0])); i++)
+	{
+		for (j = 0; j < (int)(sizeof(_scenario_modes) / sizeof(_scenario_modes[0])); j++)
+		{
+			snprintf(directory, sizeof(directory), "%s/%s_%s", BENCH_DIRECTORY, _scenarios[i].name, _scenario_modes[j]);
+			snprintf(label, sizeof(label), "%-16s %-8s", _scenarios[i].name, _scenario_modes[j]);
+			snprintf(parameters, sizeof(parameters), "\"scenario\":\"%s\",\"mode\":\"%s\",\"size\":%d", _scenarios[i].name, _scenario_modes[j], _scenarios[i].size);
+
+			if (WriteScenarioProject(directory, &_scenarios[i], _scenario_modes[j], runs.elementsPath) != 0)
+				FailBenchRun(&runs, label, directory);
+			else if (RunBenchProject(&runs, directory, BENCH_RESULT_PREFIX, label, parameters, result, sizeof(result)) == 0)
+				fprintf(stderr, "%s : %12.0f nodes/sec, hop latency %8.0f ns, %8.0f bytes/node\n", label,
+					GetBenchResultField(result, "nodesPerSec"), GetBenchResultField(result, "hopLatencyAvgNs"), GetBenchResultField(result, "memoryPerNodeBytes"));
+		}
+	}
+
+	return EndBenchRuns(&runs);
+}
+
+/**
+* Runs event generator for each combination of producer threads, buffer length and consumer cost.
+* Every run is separate engine process. Results are written as JSON (to file or standard output), summary to standard error
+*
+* @param	argc	number of benchmark arguments
+* @param	argv	benchmark arguments : engine executable, Elements directory, optional seconds per run and optional JSON output file
+* @return	exit code
+*/
+int BenchEvents(int argc, char** argv)
+{
+	benchRuns runs;
+	char directory[MAX_PATH];
+	char label[64];
+	char parameters[256];
+	char result[BENCH_RESULT_LENGTH];
+	int i, j, k;
+
+	if (BeginBenchRuns(&runs, argc, argv) != 0)
+		return 1;
+
+	for (i = 0; i < (int)(sizeof(_events_producers) / sizeof(_events_producers[0])); i++)
+	{
+		for (j = 0; j < (int)(sizeof(_events_buffer_lengths) / sizeof(_events_buffer_lengths[0])); j++)
+		{
+			for (k = 0; k < (int)(sizeof(_events_consumer_costs) / sizeof(_events_consumer_costs[0])); k++)
+			{
+				snprintf(directory, sizeof(directory), "%s/events_p%d_b%d_c%d", BENCH_DIRECTORY, _events_producers[i], _events_buffer_lengths[j], _events_consumer_costs[k]);
+				snprintf(label, sizeof(label), "producers %d, buffer %6d, cost %6d ns", _events_producers[i], _events_buffer_lengths[j], _events_consumer_costs[k]);
+				snprintf(parameters, sizeof(parameters), "\"producers\":%d,\"bufferLength\":%d,\"consumerCostNs\":%d",
+					_events_producers[i], _events_buffer_lengths[j], _events_consumer_costs[k]);
+
+				// Generator prints its result on exit, after engine's bench result
+				if (WriteEventsProject(directory, runs.elementsPath, _events_producers[i], _events_buffer_lengths[j], _events_consumer_costs[k]) != 0)
+					FailBenchRun(&runs, label, directory);
+				else if (RunBenchProject(&runs, directory, EVENTS_RESULT_PREFIX, label, parameters, result, sizeof(result)) == 0)
+					fprintf(stderr, "%s : %10.0f pushed/sec, %10.0f processed/sec, drop rate %6.4f, latency p50 %10.0f ns, p99 %10.0f ns\n", label,
+						GetBenchResultField(result, "pushedPerSec"), GetBenchResultField(result, "processedPerSec"), GetBenchResultField(result, "dropRate"),
+						GetBenchResultField(result, "latencyP50Ns"), GetBenchResultField(result, "latencyP99Ns"));
+			}
+		}
+	}
+
+	return EndBenchRuns(&runs);
+}
+//*************************************************************************/
+//************************ END SCENARIO BENCHMARK *************************/
+//*************************************************************************/
+
+//*************************************************************************/
+//************************ START RESULTS BENCHMARK ************************/
+//*************************************************************************/
+
+// Node, that results are published to, and shared counters of results benchmark
+typedef struct
+{
+	Node* node;
+	volatile int isRunning;
+	volatile long long publishesCnt;
+	volatile long long snapshotsCnt;
+	volatile long long tornCnt;
+} resultsBench;
+
+/**
+* Publishes strings of one repeated character, whose length is derived from character, until benchmark stops
+*
+* @param	arg		results benchmark
+* @return	NULL
+*/
+void* PublishResults(void* arg)
+{
+	resultsBench* bench = arg;
+	char str[RESULTS_MAX_LENGTH + 1];
+	long long i;
+	int length;
+
+	for (i = 0; ATOMIC_LOAD(&bench->isRunning); i++)
+	{
+		length = 1 + (int)((i * 37) % RESULTS_MAX_LENGTH);
+		memset(str, 'a' + length % 26, length);
+		str[length] = '\0';
+		common_result_set_string(bench->node, str);
+	}
+	bench->publishesCnt = i;
+	return NULL;
+}
+
+/**
+* Takes snapshots of published strings and checks that character and length match, until benchmark stops
+*
+* @param	arg		results benchmark
+* @return	NULL
+*/
+void* SnapshotResults(void* arg)
+{
+	resultsBench* bench = arg;
+	zen_value_t snapshot = { 0 };
+	const char* str;
+	long long i, tornCnt = 0;
+	int j;
+
+	for (i = 0; ATOMIC_LOAD(&bench->isRunning); i++)
+	{
+		common_result_snapshot(bench->node, &snapshot);
+		str = common_value_get_string(&snapshot);
+		if (str == NULL || snapshot.length == 0)
+			continue;
+		if ((int)strlen(str) != snapshot.length || str[0] != 'a' + snapshot.length % 26)
+		{
+			tornCnt++;
+			continue;
+		}
+		for (j = 1; j < snapshot.length; j++)
+		{
+			if (str[j] != str[0])
+			{
+				tornCnt++;
+				break;
+			}
+		}
+	}
+	common_value_clear(&snapshot);
+	ATOMIC_ADD64(&bench->snapshotsCnt, i);
+	ATOMIC_ADD64(&bench->tornCnt, tornCnt);
+	return NULL;
+}
+
+/**
+* Publishes node results while other threads take snapshots of them. Publisher never waits for readers,
+* so publishes/sec shouldn't drop with more readers, and no snapshot may be torn
+*
+* @param	argc	number of benchmark arguments
+* @param	argv	benchmark arguments : optional seconds and number of reader threads
+* @return	exit code
+*/
+int BenchResults(int argc, char** argv)
+{
+	resultsBench bench;
+	pthread_t publisher, readers[64];
+	int i, seconds, readersCnt;
+
+	seconds = argc > 0 ? atoi(argv[0]) : DEFAULT_RESULTS_SECONDS;
+	readersCnt = argc > 1 ? atoi(argv[1]) : DEFAULT_RESULTS_READERS;
+	if (seconds <= 0)
+		seconds = DEFAULT_RESULTS_SECONDS;
+	if (readersCnt <= 0 || readersCnt > 64)
+		readersCnt = DEFAULT_RESULTS_READERS;
+
+	memset(&bench, 0, sizeof(bench));
+	bench.node = calloc(1, sizeof(Node));
+	bench.isRunning = 1;
+
+	pthread_create(&publisher, NULL, PublishResults, &bench);
+	for (i = 0; i < readersCnt; i++)
+		pthread_create(&readers[i], NULL, SnapshotResults, &bench);
+#if defined(_WIN32)
+	Sleep(seconds * 1000);
+#else
+	sleep(seconds);
+#endif
+	ATOMIC_STORE(&bench.isRunning, 0);
+	pthread_join(publisher, NULL);
+	for (i = 0; i < readersCnt; i++)
+		pthread_join(readers[i], NULL);
+
+	printf("Readers             : %d\n", readersCnt);
+	printf("Publishes           : %.0f /sec\n", (double)bench.publishesCnt / seconds);
+	printf("Snapshots           : %.0f /sec\n", (double)bench.snapshotsCnt / seconds);
+	printf("Torn snapshots      : %lld\n", bench.tornCnt);
+
+	common_value_clear(&bench.node->resultSlots[0]);
+	common_value_clear(&bench.node->resultSlots[1]);
+	free(bench.node);
+	return bench.tornCnt == 0 ? 0 : 1;
+}
+//*************************************************************************/
+//************************ END RESULTS BENCHMARK **************************/
+//*************************************************************************/
+
+int main(int argc, char **argv)
+{
+	if (argc > 1 && strcmp(argv[1], "vtable") == 0)
+		return BenchVTable(argc - 2, argv + 2);
+	if (argc > 1 && strcmp(argv[1], "layout") == 0)
+		return BenchLayout(argc - 2, argv + 2);
+	if (argc > 1 && strcmp(argv[1], "scenarios") == 0)
+		return BenchScenarios(argc - 2, argv + 2);
+	if (argc > 1 && strcmp(argv[1], "events") == 0)
+		return BenchEvents(argc - 2, argv + 2);
+	if (argc > 1 && strcmp(argv[1], "results") == 0)
+		return BenchResults(argc - 2, argv + 2);
+
+	printf("Usage:\n");
+	printf("  ZenBench vtable <implementation library> [iterations]\n");
+	printf("  ZenBench layout [rounds]\n");
+	printf("  ZenBench scenarios <engine executable> <Elements directory> [seconds] [output.json]\n");
+	printf("  ZenBench events <engine executable> <Elements directory> [seconds] [output.json]\n");
+	printf("  ZenBench results [seconds] [readers]\n");
+	return 1;
+}
@@ -0,0 +1,66 @@
+/*************************************************************************
+ * Copyright (c) 2015, 2018 Zenodys BV
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contributors:
+ *    Tomaž Vinko
+ *   
+ **************************************************************************/
+
+/*
+* Atomic operations on int values, 64 bit values (64 macros) and pointers (_PTR macros), shared between C engine, Elements and CoreCLR (C++) bindings.
+* C11 <stdatomic.h> can't be used here, because this header is included from C++ code and from MSVC C compiler,
+* which doesn't support it. Instead, GCC builtins and MSVC Interlocked intrinsics are used.
+* All operations are sequentially consistent, except ATOMIC_STORE_RELEASE, which is meant for publishing
+* data written by single writer on hot paths (plain store on x86/x64).
+*/
+#pragma once
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define ATOMIC_LOAD(ptr)						_InterlockedOr((volatile long*)(ptr), 0)
+#define ATOMIC_STORE(ptr, val)					_InterlockedExchange((volatile long*)(ptr), (long)(val))
+#define ATOMIC_STORE_RELEASE(ptr, val)			do { _ReadWriteBarrier(); *(volatile long*)(ptr) = (long)(val); } while (0)
+#define ATOMIC_EXCHANGE(ptr, val)				_InterlockedExchange((volatile long*)(ptr), (long)(val))
+#define ATOMIC_ADD(ptr, val)					(_InterlockedExchangeAdd((volatile long*)(ptr), (long)(val)) + (val))
+#define ATOMIC_CAS(ptr, expected, desired)		(_InterlockedCompareExchange((volatile long*)(ptr), (long)(desired), (long)(expected)) == (long)(expected))
+// Interlocked operations are full barriers
+#define ATOMIC_FENCE()							do { volatile long _atomic_fence = 0; _InterlockedExchange(&_atomic_fence, 0); } while (0)
+// 64 bit operations, for timestamps and counters that must not tear on 32 bit targets
+#define ATOMIC_STORE64(ptr, val)				_InterlockedExchange64((volatile __int64*)(ptr), (__int64)(val))
+#define ATOMIC_EXCHANGE64(ptr, val)				((uint64_t)_InterlockedExchange64((volatile __int64*)(ptr), (__int64)(val)))
+#define ATOMIC_ADD64(ptr, val)					(_InterlockedExchangeAdd64((volatile __int64*)(ptr), (__int64)(val)) + (val))
+// Pointer operations
+#define ATOMIC_LOAD_PTR(ptr)					_InterlockedCompareExchangePointer((void* volatile*)(ptr), NULL, NULL)
+#define ATOMIC_STORE_PTR(ptr, val)				_InterlockedExchangePointer((void* volatile*)(ptr), (void*)(val))
+#define ATOMIC_CAS_PTR(ptr, expected, desired)	(_InterlockedCompareExchangePointer((void* volatile*)(ptr), (void*)(desired), (void*)(expected)) == (void*)(expected))
+#else
+#define ATOMIC_LOAD(ptr)						__atomic_load_n((ptr), __ATOMIC_SEQ_CST)
+#define ATOMIC_STORE(ptr, val)					__atomic_store_n((ptr), (val), __ATOMIC_SEQ_CST)
+#define ATOMIC_STORE_RELEASE(ptr, val)			__atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+#define ATOMIC_EXCHANGE(ptr, val)				__atomic_exchange_n((ptr), (val), __ATOMIC_SEQ_CST)
+#define ATOMIC_ADD(ptr, val)					__atomic_add_fetch((ptr), (val), __ATOMIC_SEQ_CST)
+#define ATOMIC_CAS(ptr, expected, desired)		__extension__ ({ __typeof__(*(ptr) + 0) _atomic_expected = (expected); \
+												__atomic_compare_exchange_n((ptr), &_atomic_expected, (desired), 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST); })
+#define ATOMIC_FENCE()							__atomic_thread_fence(__ATOMIC_SEQ_CST)
+// 64 bit operations, for timestamps and counters that must not tear on 32 bit targets
+#define ATOMIC_STORE64(ptr, val)				ATOMIC_STORE(ptr, val)
+#define ATOMIC_EXCHANGE64(ptr, val)				ATOMIC_EXCHANGE(ptr, val)
+#define ATOMIC_ADD64(ptr, val)					ATOMIC_ADD(ptr, val)
+// Pointer operations
+#define ATOMIC_LOAD_PTR(ptr)					ATOMIC_LOAD(ptr)
+#define ATOMIC_STORE_PTR(ptr, val)				ATOMIC_STORE(ptr, val)
+#define ATOMIC_CAS_PTR(ptr, expected, desired)	ATOMIC_CAS(ptr, expected, desired)
+#endif
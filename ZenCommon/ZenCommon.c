@@ -43,16 +43,33 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <sched.h>
 #include "dirent.h"
 #include "cJSON.h"
 #include <sys/stat.h>
 
 Node**				_nodeList;
 int					_nodeListLength;
+Node**				_nodeIndex;
+unsigned			_nodeIndexMask;
+
+// Interned argument keys. Handle is index in _internedKeys
+char**				_internedKeys;
+int					_internedKeysCnt;
+int*				_internIndex;
+unsigned			_internIndexSize;
+pthread_mutex_t		_intern_lock = PTHREAD_MUTEX_INITIALIZER;
+// Serializes setters of node arguments
+pthread_mutex_t		_node_args_lock = PTHREAD_MUTEX_INITIALIZER;
 unsigned			_isDebugMode;
 char				_project_root[256];
 char				_project_id[256];
 ptrExecNode			_execNodeFunct;
+ptrSignalNode		_signalNodeFunct;
 EngineConfiguration _engineConfiguration;
 
 EXTERN_DLL_EXPORT char* COMMON_PROJECT_ROOT{ return (_project_root); }
@@ -61,11 +78,25 @@ EXTERN_DLL_EXPORT Node** COMMON_NODE_LIST{ return (_nodeList); }
 EXTERN_DLL_EXPORT int COMMON_NODE_LIST_LENGTH{ return _nodeListLength; }
 EXTERN_DLL_EXPORT EngineConfiguration COMMON_ENGINE_CONFIGURATION{ return _engineConfiguration; }
 
-pthread_cond_t _pause_node_conditions[1000];
-int _pause_node_conditions_cnt = 0;
+// Free buffer chunks shared by all event buffers
+bufferChunk* _buffer_pool[BUFFER_POOL_MAX_CHUNKS];
+int _buffer_pool_cnt = 0;
+volatile int _buffer_chunks_allocated_cnt = 0;
+pthread_mutex_t _buffer_pool_lock = PTHREAD_MUTEX_INITIALIZER;
 
-pthread_mutex_t _event_queue_locks[1000];
-int _event_queue_locks_cnt = 0;
+// Project arena. It owns all allocations that live as long as project (nodes, arguments, relations...)
+typedef struct projectArenaBlock
+{
+	struct projectArenaBlock* next;
+	size_t size;
+	size_t used;
+} projectArenaBlock;
+
+// Block data starts after header, rounded up to keep 16 byte alignment of allocations
+#define PROJECT_ARENA_HEADER_SIZE ((sizeof(projectArenaBlock) + 15) & ~(size_t)15)
+
+projectArenaBlock* _project_arena;
+pthread_mutex_t _project_arena_lock = PTHREAD_MUTEX_INITIALIZER;
 
 // Visual breakpoints handlers
 pthread_cond_t _debug_cond;
@@ -126,18 +157,74 @@ EXTERN_DLL_EXPORT void common_set_debug_mode(unsigned isDebugMode)
 */
 EXTERN_DLL_EXPORT void common_initialize_node_list(int nodeListCnt)
 {
-	_nodeList = malloc(nodeListCnt * sizeof(Node*));
+	unsigned indexSize = 16;
+
+	_nodeList = common_project_arena_alloc(nodeListCnt * sizeof(Node*));
+
+	// Node index is open addressing hash table, that is at most half full
+	while (indexSize < (unsigned)nodeListCnt * 2)
+		indexSize <<= 1;
+
+	_nodeIndex = common_project_arena_alloc(indexSize * sizeof(Node*));
+	_nodeIndexMask = indexSize - 1;
 }
 
 /**
-* Adds node to node list
+* Adds node to node list and node index. Node id must be already set.
 *
 * @param node		node to add in the list
 * @return           void
 */
 EXTERN_DLL_EXPORT void common_add_node_to_list(Node* node)
 {
+	unsigned slot = hash_string(node->id) & _nodeIndexMask;
+
 	_nodeList[_nodeListLength++] = node;
+
+	// Linear probing. If ids are duplicated, first node wins
+	while (_nodeIndex[slot] != NULL)
+	{
+		if (strcmp(_nodeIndex[slot]->id, node->id) == 0)
+			return;
+		slot = (slot + 1) & _nodeIndexMask;
+	}
+	_nodeIndex[slot] = node;
+}
+
+/**
+* FNV-1a hash of string (node ids, argument keys)
+*
+* @param str	string to hash
+* @return       hash
+*/
+unsigned hash_string(const char* str)
+{
+	unsigned hash = 2166136261u;
+	while (*str)
+	{
+		hash ^= (unsigned char)*str++;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/**
+* FNV-1a hash of string span. Same as hash_string of zero terminated copy
+*
+* @param str	start of string
+* @param length	string length
+* @return       hash
+*/
+unsigned hash_span(const char* str, int length)
+{
+	unsigned hash = 2166136261u;
+	int i;
+	for (i = 0; i < length; i++)
+	{
+		hash ^= (unsigned char)str[i];
+		hash *= 16777619u;
+	}
+	return hash;
 }
 
 /**
@@ -159,7 +246,9 @@ EXTERN_DLL_EXPORT int common_node_exists(Node** nodeArr, Node* node, int listCnt
 }
 
 /**
-* Sets value of node argument
+* Sets value of node argument. Managed scripts can set it on every loop, so project arena is not used here.
+* Value that fits into current buffer is overwritten in place, otherwise it's copied to heap. Replaced heap copy
+* is retired and freed on next reallocation, so readers that still hold it are safe
 *
 * @param nodeId		unique identifier of node that argument value is setted
 * @param key		key
@@ -168,12 +257,44 @@ EXTERN_DLL_EXPORT int common_node_exists(Node** nodeArr, Node* node, int listCnt
 */
 EXTERN_DLL_EXPORT void  common_set_node_arg(Node *node, char* key, char* value)
 {
-	int i;
+	nodeArgs* arg;
+	char* newValue;
+	int i, length;
+
 	for (i = 0; i < node->argsCnt; i++)
 	{
 		if (strcmp(key, node->args[i]->Key) == 0)
 		{
-			strncpy(node->args[i]->Value, value, strlen(value) + 1);
+			arg = node->args[i];
+			length = (int)strlen(value);
+
+			// Setters are serialized, readers retry while version is odd or changed (see read_node_arg)
+			pthread_mutex_lock(&_node_args_lock);
+			if (length < arg->ValueCapacity)
+			{
+				ATOMIC_ADD(&arg->Version, 1);
+				memcpy(arg->Value, value, length + 1);
+			}
+			else
+			{
+				newValue = malloc(length + 1);
+				if (newValue == NULL)
+				{
+					pthread_mutex_unlock(&_node_args_lock);
+					return;
+				}
+				memcpy(newValue, value, length + 1);
+
+				ATOMIC_ADD(&arg->Version, 1);
+				free(arg->RetiredValue);
+				arg->RetiredValue = arg->IsValueOwned ? arg->Value : NULL;
+				arg->Value = newValue;
+				arg->ValueCapacity = length + 1;
+				arg->IsValueOwned = 1;
+			}
+			parse_node_arg(arg);
+			ATOMIC_ADD(&arg->Version, 1);
+			pthread_mutex_unlock(&_node_args_lock);
 			return;
 		}
 	}
@@ -197,6 +318,207 @@ EXTERN_DLL_EXPORT char* common_get_node_arg(Node* node, char* key)
 	return "";
 }
 
+/**
+* Interns argument key. Same key always gets the same handle, so Elements can resolve their keys once
+* (eg. in onImplementationInit) and then access arguments without string compares
+*
+* @param key		argument key
+* @return			key handle
+*/
+EXTERN_DLL_EXPORT int common_intern_key(const char* key)
+{
+	unsigned slot, i;
+	int keyHandle;
+
+	pthread_mutex_lock(&_intern_lock);
+	// Keep hash table at most half full
+	if ((unsigned)(_internedKeysCnt + 1) * 2 > _internIndexSize)
+	{
+		unsigned newSize = _internIndexSize ? _internIndexSize * 2 : 64;
+		int* newIndex = malloc(newSize * sizeof(int));
+		for (i = 0; i < newSize; i++)
+			newIndex[i] = -1;
+
+		for (i = 0; i < (unsigned)_internedKeysCnt; i++)
+		{
+			slot = hash_string(_internedKeys[i]) & (newSize - 1);
+			while (newIndex[slot] != -1)
+				slot = (slot + 1) & (newSize - 1);
+			newIndex[slot] = i;
+		}
+		free(_internIndex);
+		_internIndex = newIndex;
+		_internIndexSize = newSize;
+		_internedKeys = realloc(_internedKeys, (newSize / 2) * sizeof(char*));
+	}
+
+	slot = hash_string(key) & (_internIndexSize - 1);
+	while (_internIndex[slot] != -1)
+	{
+		if (strcmp(_internedKeys[_internIndex[slot]], key) == 0)
+		{
+			keyHandle = _internIndex[slot];
+			pthread_mutex_unlock(&_intern_lock);
+			return keyHandle;
+		}
+		slot = (slot + 1) & (_internIndexSize - 1);
+	}
+
+	keyHandle = _internedKeysCnt++;
+	_internedKeys[keyHandle] = strdup(key);
+	_internIndex[slot] = keyHandle;
+	pthread_mutex_unlock(&_intern_lock);
+	return keyHandle;
+}
+
+/**
+* Creates node argument with interned key. Argument is allocated in project arena
+*
+* @param key		argument key
+* @param value		argument value
+* @return			node argument
+*/
+EXTERN_DLL_EXPORT nodeArgs* common_create_node_arg(const char* key, const char* value)
+{
+	nodeArgs* arg = common_project_arena_alloc(sizeof(nodeArgs));
+	arg->Key = common_project_arena_strdup(key);
+	arg->Value = common_project_arena_strdup(value);
+	arg->ValueCapacity = (int)strlen(value) + 1;
+	arg->IsValueOwned = 0;
+	arg->RetiredValue = NULL;
+	arg->KeyHandle = common_intern_key(key);
+	parse_node_arg(arg);
+	return arg;
+}
+
+/**
+* Finds node argument by interned key
+*
+* @param node		node which argument is searched
+* @param keyHandle	interned key
+* @return			node argument, or NULL if node doesn't have it
+*/
+EXTERN_DLL_EXPORT nodeArgs* common_get_node_arg_by_handle(Node* node, int keyHandle)
+{
+	int i;
+	for (i = 0; i < node->argsCnt; i++)
+	{
+		if (node->args[i]->KeyHandle == keyHandle)
+			return node->args[i];
+	}
+	return NULL;
+}
+
+/**
+* Parses typed values of node argument from its value. Called when argument is created and when its value is set
+*
+* @param arg		node argument
+* @return			void
+*/
+void parse_node_arg(nodeArgs* arg)
+{
+	const char* value = arg->Value;
+	const char* trueValue = "true";
+	int i;
+
+	arg->IntValue = atoi(value);
+	arg->DoubleValue = atof(value);
+	for (i = 0; trueValue[i] != '\0' && tolower((unsigned char)value[i]) == trueValue[i]; i++);
+	arg->BoolValue = (trueValue[i] == '\0' && value[i] == '\0') || arg->IntValue != 0;
+}
+
+/**
+* Reads typed values of node argument. Read is retried if value was set meanwhile, so values are always consistent
+*
+* @param arg			node argument
+* @param intValue		integer value (output argument)
+* @param doubleValue	double value (output argument)
+* @param boolValue		boolean value (output argument)
+* @return				void
+*/
+void read_node_arg(nodeArgs* arg, int* intValue, double* doubleValue, int* boolValue)
+{
+	int version;
+	do
+	{
+		version = ATOMIC_LOAD(&arg->Version);
+		*intValue = arg->IntValue;
+		*doubleValue = arg->DoubleValue;
+		*boolValue = arg->BoolValue;
+		ATOMIC_FENCE();
+	} while ((version & 1) || ATOMIC_LOAD(&arg->Version) != version);
+}
+
+/**
+* Gets string value of node argument
+*
+* @param node		node which argument is searched
+* @param keyHandle	interned key
+* @return			argument value, or empty string if node doesn't have it
+*/
+EXTERN_DLL_EXPORT char* common_get_node_arg_string(Node* node, int keyHandle)
+{
+	nodeArgs* arg = common_get_node_arg_by_handle(node, keyHandle);
+	return arg ? arg->Value : "";
+}
+
+/**
+* Gets integer value of node argument
+*
+* @param node		node which argument is searched
+* @param keyHandle	interned key
+* @return			argument value, or 0 if node doesn't have it
+*/
+EXTERN_DLL_EXPORT int common_get_node_arg_int(Node* node, int keyHandle)
+{
+	nodeArgs* arg = common_get_node_arg_by_handle(node, keyHandle);
+	int intValue, boolValue;
+	double doubleValue;
+	if (arg == NULL)
+		return 0;
+
+	read_node_arg(arg, &intValue, &doubleValue, &boolValue);
+	return intValue;
+}
+
+/**
+* Gets double value of node argument
+*
+* @param node		node which argument is searched
+* @param keyHandle	interned key
+* @return			argument value, or 0 if node doesn't have it
+*/
+EXTERN_DLL_EXPORT double common_get_node_arg_double(Node* node, int keyHandle)
+{
+	nodeArgs* arg = common_get_node_arg_by_handle(node, keyHandle);
+	int intValue, boolValue;
+	double doubleValue;
+	if (arg == NULL)
+		return 0;
+
+	read_node_arg(arg, &intValue, &doubleValue, &boolValue);
+	return doubleValue;
+}
+
+/**
+* Gets boolean value of node argument. "true" (case insensitive) or non zero number is true
+*
+* @param node		node which argument is searched
+* @param keyHandle	interned key
+* @return			argument value, or 0 if node doesn't have it
+*/
+EXTERN_DLL_EXPORT int common_get_node_arg_bool(Node* node, int keyHandle)
+{
+	nodeArgs* arg = common_get_node_arg_by_handle(node, keyHandle);
+	int intValue, boolValue;
+	double doubleValue;
+	if (arg == NULL)
+		return 0;
+
+	read_node_arg(arg, &intValue, &doubleValue, &boolValue);
+	return boolValue;
+}
+
 /**
 * Executes node.
 * Demand for node execution can be from managed or unmanaged code.
@@ -209,6 +531,57 @@ EXTERN_DLL_EXPORT void common_exec_node(Node* node)
 {
 	_execNodeFunct(node);
 }
+
+/**
+* Registers engine callback that wakes up paused node.
+* When callback is not registered, node's pause condition is signalled directly
+*
+* @param signalNodeFunct	callback implemented on engine
+* @return					void
+*/
+EXTERN_DLL_EXPORT void common_set_signal_node_callback(ptrSignalNode signalNodeFunct)
+{
+	_signalNodeFunct = signalNodeFunct;
+}
+
+/**
+* Wakes up paused node. Depending on engine execution mode node thread is signalled,
+* or node is put on run queue
+*
+* @param node		node to wake up
+* @return			void
+*/
+void signal_node(Node* node)
+{
+	if (_signalNodeFunct)
+		_signalNodeFunct(node);
+	else
+	{
+		common_trace_instant(TRACE_PAUSE_SIGNAL, node);
+		pthread_cond_signal(&node->sync.pauseCondition);
+	}
+}
+
+/**
+* Returns node status as string (for MQTT and debug consumers)
+*
+* @param node		node which status is returned
+* @return			status string
+*/
+EXTERN_DLL_EXPORT const char* common_get_node_status_string(Node* node)
+{
+	switch (ATOMIC_LOAD(&node->status))
+	{
+	case NODE_STATUS_RUNNING:
+		return "RUNNING";
+	case NODE_STATUS_ARRIVED:
+		return "ARRIVED";
+	case NODE_STATUS_STOPPED:
+		return "STOPPED";
+	default:
+		return "IDLE";
+	}
+}
 //************************ End node operations   **************************/
 
 //*************************************************************************/
@@ -233,180 +606,989 @@ EXTERN_DLL_EXPORT void common_exec_node(Node* node)
 */
 
 /**
-* Triggering node (eg OpcUa) is called from trigger node (eg Debug). Function sets result and signal's triggering node's thread.
+* Triggering node (eg OpcUa) is called from trigger node (eg Debug). Function gives green light to triggering node,
+* and delivers next buffered event if there is any.
+*
+* @param node			triggered node
+
+* @return				void
+*/
+EXTERN_DLL_EXPORT void common_pull_event_from_buffer(Node* node)
+{
+	ATOMIC_STORE(&node->hasGreenLight, 1);
+	deliver_buffered_event(node);
+}
+
+/**
+* Called from event generator (eg OpcClientSubs). Event is saved to lock-free buffer, and workflow is signalled
+* with it if triggering node has green light (loop is not busy). Otherwise, event stays in buffer until next pull.
+*
+* Data is interpreted by node's result type : INT data is copied, other data is only borrowed.
+*
+* @param context	struct with node and result info
+* @return			void
+*/
+EXTERN_DLL_EXPORT void common_push_event_to_buffer(void *context)
+{
+	struct eventContextParamsStruct *eventParams = context;
+	zen_value_t event = { 0 };
+	result_type eventType;
+
+	// In batch mode last result type is RESULT_TYPE_EVENTS_BATCH, so type of single event is kept in batch
+	eventType = eventParams->node->batchedEvents != NULL ? eventParams->node->batchedEvents->eventsType : eventParams->node->lastResultType;
+	if (eventType == RESULT_TYPE_INT)
+		common_value_set_int(&event, *(int*)eventParams->data);
+	else if (eventType == RESULT_TYPE_CHAR_ARRAY || eventType == RESULT_TYPE_JSON_STRING)
+		common_value_set_string_ref(&event, (char*)eventParams->data, -1);
+	else
+		common_value_set_blob_ref(&event, eventParams->data, 0);
+	event.type = eventType;
+
+	common_push_value_to_buffer(eventParams->node, &event);
+}
+
+/**
+* Called from event generator. Value is moved to lock-free buffer (buffer takes over owned data, value is left empty),
+* and workflow is signalled with it if triggering node has green light.
+*
+* @param node		triggering node
+* @param value		event value
+* @return			void
+*/
+EXTERN_DLL_EXPORT void common_push_value_to_buffer(Node* node, zen_value_t* value)
+{
+	zen_value_t event;
+
+	// Node has not yet been initialized (workflow didn't visit yet our node). In this case ignore it and do not fill any buffer yet
+	// Beware to not come before pausing node. Look at the ZenEngine....
+	if (!node->isEventActive)
+	{
+		common_value_clear(value);
+		return;
+	}
+
+	event = *value;
+	value->isOwned = 0;
+	common_value_clear(value);
+
+	push_with_overflow_policy(node, &event);
+	common_trace_instant(TRACE_EVENT_PUSH, node);
+	deliver_buffered_event(node);
+}
+
+/**
+* Pushes event to node's buffer. When buffer is full, node's overflow policy is applied and drops are counted.
+* Data of dropped events is freed
+*
+* @param node		triggering node
+* @param event		event to push
+* @return			void
+*/
+void push_with_overflow_policy(Node* node, zen_value_t* event)
+{
+	buffer_t* buffer = node->bufferedEvents;
+	zen_value_t droppedEvent;
+	struct timespec timeout;
+
+	switch (buffer->overflowPolicy)
+	{
+		case OVERFLOW_POLICY_DROP_OLDEST:
+			while (!push(buffer, event))
+			{
+				if (popqueue(buffer, &droppedEvent))
+				{
+					common_value_clear(&droppedEvent);
+					ATOMIC_ADD(&buffer->droppedCnt, 1);
+				}
+			}
+			return;
+
+		case OVERFLOW_POLICY_BLOCK:
+			if (push(buffer, event))
+				return;
+
+			get_abs_time(&timeout, buffer->overflowTimeout);
+			pthread_mutex_lock(&node->sync.eventQueueLock);
+			// Register before retrying, so that consumer either sees waiting producer, or producer sees free space
+			ATOMIC_ADD(&buffer->blockedProducersCnt, 1);
+			while (!push(buffer, event))
+			{
+				if (pthread_cond_timedwait(&node->sync.eventQueueCondition, &node->sync.eventQueueLock, &timeout) == ETIMEDOUT)
+				{
+					if (!push(buffer, event))
+					{
+						common_value_clear(event);
+						ATOMIC_ADD(&buffer->droppedCnt, 1);
+					}
+					break;
+				}
+			}
+			ATOMIC_ADD(&buffer->blockedProducersCnt, -1);
+			pthread_mutex_unlock(&node->sync.eventQueueLock);
+			return;
+
+		case OVERFLOW_POLICY_COALESCE_LATEST:
+			// Once buffer has overflowed, events are coalesced until consumer takes coalesced event, so that order is kept
+			if (!ATOMIC_LOAD(&buffer->hasCoalescedElement) && push(buffer, event))
+				return;
+
+			pthread_mutex_lock(&node->sync.eventQueueLock);
+			if (buffer->hasCoalescedElement)
+			{
+				common_value_clear(&buffer->coalescedElement);
+				ATOMIC_ADD(&buffer->droppedCnt, 1);
+			}
+			buffer->coalescedElement = *event;
+			ATOMIC_STORE(&buffer->hasCoalescedElement, 1);
+			pthread_mutex_unlock(&node->sync.eventQueueLock);
+			return;
+
+		default:
+			if (!push(buffer, event))
+			{
+				common_value_clear(event);
+				ATOMIC_ADD(&buffer->droppedCnt, 1);
+			}
+			return;
+	}
+}
+
+/**
+* Takes next events for node : first from buffer, then coalesced event.
+* Producers, blocked on full buffer, are woken up once for all taken events.
+*
+* @param node		triggering node
+* @param events		taken events (output argument). Caller takes over their data
+* @param maxCnt		maximum number of events to take
+* @return			number of taken events
+*/
+int take_buffered_events(Node* node, zen_value_t* events, int maxCnt)
+{
+	buffer_t* buffer = node->bufferedEvents;
+	int takenCnt = popqueue_many(buffer, events, maxCnt);
+
+	// Coalesced event is newer than all buffered ones, so it can be taken only when buffer is drained
+	if (takenCnt < maxCnt && ATOMIC_LOAD(&buffer->hasCoalescedElement) && !has_elements(buffer))
+	{
+		pthread_mutex_lock(&node->sync.eventQueueLock);
+		if (buffer->hasCoalescedElement)
+		{
+			events[takenCnt++] = buffer->coalescedElement;
+			ATOMIC_STORE(&buffer->hasCoalescedElement, 0);
+		}
+		pthread_mutex_unlock(&node->sync.eventQueueLock);
+	}
+
+	if (takenCnt > 0 && ATOMIC_LOAD(&buffer->blockedProducersCnt) > 0)
+	{
+		pthread_mutex_lock(&node->sync.eventQueueLock);
+		pthread_cond_broadcast(&node->sync.eventQueueCondition);
+		pthread_mutex_unlock(&node->sync.eventQueueLock);
+	}
+	return takenCnt;
+}
+
+/**
+* Delivers buffered event to triggering node and signals it. Event is delivered only by thread,
+* that takes green light from the node, so node is signalled only when it's ready for next event.
+* In batch mode, all buffered events up to batch size are delivered with single signal.
+* If green light is returned because buffer was empty, buffer is checked again, so that event pushed
+* in the meantime is not left in buffer.
+*
+* @param node		triggering node
+* @return			void
+*/
+void deliver_buffered_event(Node* node)
+{
+	zen_value_t event;
+	int i, eventsCnt;
+
+	while (ATOMIC_CAS(&node->hasGreenLight, 1, 0))
+	{
+		// Green light is taken, so previous result is no longer used by workflow
+		if (node->batchedEvents != NULL)
+		{
+			for (i = 0; i < node->batchedEvents->eventsCnt; i++)
+				common_value_clear(&node->batchedEvents->events[i]);
+			node->batchedEvents->eventsCnt = 0;
+			eventsCnt = take_buffered_events(node, node->batchedEvents->events, node->batchedEvents->capacity);
+		}
+		else
+			eventsCnt = take_buffered_events(node, &event, 1);
+
+		if (eventsCnt == 0)
+		{
+			ATOMIC_STORE(&node->hasGreenLight, 1);
+			if (!has_elements(node->bufferedEvents) && !ATOMIC_LOAD(&node->bufferedEvents->hasCoalescedElement))
+				return;
+			continue;
+		}
+		common_trace_instant(TRACE_EVENT_PULL, node);
+
+		if (node->batchedEvents != NULL)
+		{
+			node->batchedEvents->eventsCnt = eventsCnt;
+			node->lastResult = (void**)node->batchedEvents;
+			node->lastResultType = RESULT_TYPE_EVENTS_BATCH;
+			signal_node(node);
+			return;
+		}
+
+		common_result_publish(node, &event);
+		switch (node->lastResultType)
+		{
+			case RESULT_TYPE_INT:
+				node->lastResult = (void**)(intptr_t)common_result_get(node)->as.intValue;
+				break;
+
+			case RESULT_TYPE_CHAR_ARRAY:
+				if (node->lastResult == NULL)
+					node->lastResult = (char**)malloc(sizeof(char*));
+
+				*node->lastResult = (char*)common_value_get_string(common_result_get(node));
+				break;
+
+			// Same as string, length of blob is read with common_result_get
+			case RESULT_TYPE_BLOB:
+				if (node->lastResult == NULL)
+					node->lastResult = (void**)malloc(sizeof(void*));
+
+				*node->lastResult = (void*)common_value_get_data(common_result_get(node));
+				break;
+
+			// Batches are delivered above, other types are read with common_result_get
+			default:
+				break;
+		}
+		signal_node(node);
+		return;
+	}
+}
+
+/**
+* Inits event queue lock and condition, embedded in node
+*
+* @param node		node, which lock is going to be inited
+* @return			void
+*/
+EXTERN_DLL_EXPORT void common_init_event_queue_lock(Node* node)
+{
+	pthread_cond_init(&node->sync.eventQueueCondition, NULL);
+	pthread_mutex_init(&node->sync.eventQueueLock, NULL);
+}
+
+/**
+* Switches node to batch mode. Up to batchSize buffered events are delivered at once,
+* as RESULT_TYPE_EVENTS_BATCH result. Must be called after node has set its last result type
+*
+* @param node		triggering node
+* @param batchSize	maximum number of events in batch
+* @return			void
+*/
+EXTERN_DLL_EXPORT void common_init_events_batch(Node* node, int batchSize)
+{
+	eventsBatch* batch = malloc(sizeof(eventsBatch));
+	batch->eventsType = node->lastResultType;
+	batch->eventsCnt = 0;
+	batch->capacity = batchSize;
+	batch->events = calloc(batchSize, sizeof(zen_value_t));
+	node->batchedEvents = batch;
+}
+
+/**
+* Inits pause condition, embedded in node. Signalling must be unique per node thread
+*
+* @param	node	node, which pause condition is going to be inited
+* @return	void
+*/
+EXTERN_DLL_EXPORT void common_init_pause_condition(Node* node)
+{
+	pthread_cond_init(&node->sync.pauseCondition, NULL);
+}
+
+/**
+* Signals pause condition.
+*
+* @param	node	node, which loop is going to be resumed
+* @return	void
+*/
+EXTERN_DLL_EXPORT void common_signal_pause_condition(Node* node)
+{
+	pthread_cond_signal(&node->sync.pauseCondition);
+}
+
+/**
+* Pauses node main loop.
+*
+* @param	node				node, which loop is going to be paused
+* @param	pause_node_mutex	mutext, required as pthread_cond_wait parameter
+*
+* @return	void
+*/
+EXTERN_DLL_EXPORT void common_wait_pause_condition(Node* node, pthread_mutex_t *pause_node_mutex)
+{
+	uint64_t traceBegin = common_trace_begin();
+	pthread_cond_wait(&node->sync.pauseCondition, pause_node_mutex);
+	common_trace_end(TRACE_PAUSE_WAIT, node, traceBegin);
+}
+
+//*************************************************************************/
+//*********************** End Event Buffer Handling   *********************/
+//*************************************************************************/
+
+//*************************************************************************/
+//*********************** Start Value Handling ****************************/
+//*************************************************************************/
+
+/**
+* Frees owned data of value and leaves it as empty INT value
+*
+* @param value		value to clear
+* @return			void
+*/
+EXTERN_DLL_EXPORT void common_value_clear(zen_value_t* value)
+{
+	if (value->isOwned)
+		free((void*)value->as.data);
+
+	value->type = RESULT_TYPE_INT;
+	value->length = 0;
+	value->isOwned = 0;
+	value->isInline = 0;
+	value->as.intValue = 0;
+}
+
+/**
+* Moves value. Destination is cleared first and takes over data of source, which is left empty
+*
+* @param destination	value to move to
+* @param source			value to move from
+* @return				void
+*/
+EXTERN_DLL_EXPORT void common_value_move(zen_value_t* destination, zen_value_t* source)
+{
+	common_value_clear(destination);
+	*destination = *source;
+	source->isOwned = 0;
+	common_value_clear(source);
+}
+
+/**
+* Sets INT value
+*
+* @param value		value to set
+* @param intValue	integer
+* @return			void
+*/
+EXTERN_DLL_EXPORT void common_value_set_int(zen_value_t* value, int64_t intValue)
+{
+	common_value_clear(value);
+	value->as.intValue = intValue;
+}
+
+/**
+* Sets DOUBLE value
+*
+* @param value			value to set
+* @param doubleValue	double
+* @return				void
+*/
+EXTERN_DLL_EXPORT void common_value_set_double(zen_value_t* value, double doubleValue)
+{
+	common_value_clear(value);
+	value->type = RESULT_TYPE_DOUBLE;
+	value->as.doubleValue = doubleValue;
+}
+
+/**
+* Sets BOOL value
+*
+* @param value		value to set
+* @param boolValue	0 or 1
+* @return			void
+*/
+EXTERN_DLL_EXPORT void common_value_set_bool(zen_value_t* value, int boolValue)
+{
+	common_value_clear(value);
+	value->type = RESULT_TYPE_BOOL;
+	value->as.boolValue = boolValue != 0;
+}
+
+/**
+* Copies data into value. Data up to inline size is stored inside value, longer data is copied to heap and owned by value
+*
+* @param value		value to set
+* @param data		data to copy
+* @param length		data length in bytes
+* @param extraCnt	extra zero bytes after data (terminating zero of strings)
+* @return			void
+*/
+void copy_value_data(zen_value_t* value, const void* data, int length, int extraCnt)
+{
+	char* copy;
+	common_value_clear(value);
+	if (length + extraCnt <= VALUE_INLINE_SIZE)
+	{
+		copy = value->as.inlineData;
+		value->isInline = 1;
+	}
+	else
+	{
+		copy = malloc(length + extraCnt);
+		value->as.data = copy;
+		value->isOwned = 1;
+	}
+	memcpy(copy, data, length);
+	memset(copy + length, 0, extraCnt);
+	value->length = length;
+}
+
+/**
+* Sets CHAR_ARRAY value to copy of string
+*
+* @param value		value to set
+* @param str		zero terminated string
+* @return			void
+*/
+EXTERN_DLL_EXPORT void common_value_set_string(zen_value_t* value, const char* str)
+{
+	copy_value_data(value, str, (int)strlen(str), 1);
+	value->type = RESULT_TYPE_CHAR_ARRAY;
+}
+
+/**
+* Sets CHAR_ARRAY value to borrowed string. String is not copied nor freed
+*
+* @param value		value to set
+* @param str		zero terminated string
+* @param length		string length, or negative if it should be calculated
+* @return			void
+*/
+EXTERN_DLL_EXPORT void common_value_set_string_ref(zen_value_t* value, const char* str, int length)
+{
+	common_value_clear(value);
+	value->type = RESULT_TYPE_CHAR_ARRAY;
+	value->length = length < 0 ? (int)strlen(str) : length;
+	value->as.data = str;
+}
+
+/**
+* Sets CHAR_ARRAY value to malloc-ed string. Value takes over string and frees it when it's cleared
+*
+* @param value		value to set
+* @param str		zero terminated, malloc-ed string
+* @return			void
+*/
+EXTERN_DLL_EXPORT void common_value_take_string(zen_value_t* value, char* str)
+{
+	common_value_clear(value);
+	value->type = RESULT_TYPE_CHAR_ARRAY;
+	value->length = (int)strlen(str);
+	value->as.data = str;
+	value->isOwned = 1;
+}
+
+/**
+* Sets BLOB value to copy of data
+*
+* @param value		value to set
+* @param data		data to copy
+* @param length		data length in bytes
+* @return			void
+*/
+EXTERN_DLL_EXPORT void common_value_set_blob(zen_value_t* value, const void* data, int length)
+{
+	copy_value_data(value, data, length, 0);
+	value->type = RESULT_TYPE_BLOB;
+}
+
+/**
+* Sets BLOB value to borrowed data. Data is not copied nor freed
+*
+* @param value		value to set
+* @param data		data
+* @param length		data length in bytes
+* @return			void
+*/
+EXTERN_DLL_EXPORT void common_value_set_blob_ref(zen_value_t* value, const void* data, int length)
+{
+	common_value_clear(value);
+	value->type = RESULT_TYPE_BLOB;
+	value->length = length;
+	value->as.data = data;
+}
+
+/**
+* Gets string or blob data of value, without copying
+*
+* @param value		value
+* @return			pointer to data, valid until value is changed
+*/
+EXTERN_DLL_EXPORT const void* common_value_get_data(const zen_value_t* value)
+{
+	return value->isInline ? value->as.inlineData : value->as.data;
+}
+
+/**
+* Gets string of CHAR_ARRAY or JSON_STRING value, without copying
+*
+* @param value		value
+* @return			string, valid until value is changed, or NULL if value is not string
+*/
+EXTERN_DLL_EXPORT const char* common_value_get_string(const zen_value_t* value)
+{
+	if (value->type != RESULT_TYPE_CHAR_ARRAY && value->type != RESULT_TYPE_JSON_STRING)
+		return NULL;
+	return (const char*)common_value_get_data(value);
+}
+
+/**
+* Frees heap data of overwritten result slot, that were kept because readers were still copying it
+*
+* @param node		node
+* @param slotIndex	result slot
+* @return			void
+*/
+void free_retired_results(Node* node, int slotIndex)
+{
+	retiredResult* retired;
+	while (node->retiredResults[slotIndex] != NULL)
+	{
+		retired = node->retiredResults[slotIndex];
+		node->retiredResults[slotIndex] = retired->next;
+		free(retired->data);
+		free(retired);
+	}
+}
+
+/**
+* Publishes node result. Value is moved to slot, that readers don't use, and then sequence is increased.
+* Sequence is odd while slot is being written. Published slot is (sequence / 2) % 2, written slot is the other one.
+* Only node itself (or thread that delivers its event) may publish, so there is single writer per node.
+* Writer never waits for readers : if readers that started before may still copy heap data of overwritten slot,
+* data is retired and freed by later publish into the same slot, once slot has no readers
+*
+* @param node		node
+* @param value		new result. It's left empty
+* @return			void
+*/
+EXTERN_DLL_EXPORT void common_result_publish(Node* node, zen_value_t* value)
+{
+	unsigned sequence = node->resultSequence;
+	int slotIndex = ((sequence >> 1) + 1) & 1;
+	zen_value_t* slot = &node->resultSlots[slotIndex];
+	retiredResult* retired;
+
+	ATOMIC_STORE(&node->resultSequence, sequence + 1);
+	ATOMIC_FENCE();
+
+	// Slot was published two results ago. Readers, that start now, already see odd sequence and read the other slot
+	if (ATOMIC_LOAD(&node->resultReadersCnt[slotIndex]) == 0)
+		free_retired_results(node, slotIndex);
+	else if (slot->isOwned)
+	{
+		retired = malloc(sizeof(retiredResult));
+		retired->data = (void*)slot->as.data;
+		retired->next = node->retiredResults[slotIndex];
+		node->retiredResults[slotIndex] = retired;
+		slot->isOwned = 0;
+	}
+
+	common_value_move(slot, value);
+	ATOMIC_STORE(&node->resultSequence, sequence + 2);
+}
+
+/**
+* Gets consistent copy of node result, without blocking node. Can be called from any thread.
+* String and blob data is copied too, so snapshot stays valid after node publishes new result
+*
+* @param node		node
+* @param snapshot	result copy (output argument). Previous data of snapshot is freed
+* @return			void
+*/
+EXTERN_DLL_EXPORT void common_result_snapshot(Node* node, zen_value_t* snapshot)
+{
+	unsigned startSequence, endSequence;
+	int slotIndex;
+	zen_value_t slot;
+
+	for (;;)
+	{
+		// Reader announces itself on slot before it checks sequence, so writer, that overwrites slot later, keeps its heap data.
+		// Slot is overwritten only after two more publishes, so copy is consistent if there was at most one.
+		// Slot itself is checked before its data is copied, so torn length or pointer is never used
+		startSequence = ATOMIC_LOAD(&node->resultSequence);
+		slotIndex = (startSequence >> 1) & 1;
+		ATOMIC_ADD(&node->resultReadersCnt[slotIndex], 1);
+		slot = node->resultSlots[slotIndex];
+		ATOMIC_FENCE();
+		if (ATOMIC_LOAD(&node->resultSequence) - (startSequence & ~1u) > 2)
+		{
+			ATOMIC_ADD(&node->resultReadersCnt[slotIndex], -1);
+			continue;
+		}
+
+		common_value_clear(snapshot);
+		if (slot.type == RESULT_TYPE_CHAR_ARRAY || slot.type == RESULT_TYPE_JSON_STRING || slot.type == RESULT_TYPE_BLOB)
+			copy_value_data(snapshot, common_value_get_data(&slot), slot.length, slot.type == RESULT_TYPE_BLOB ? 0 : 1);
+		else
+			*snapshot = slot;
+		snapshot->type = slot.type;
+		ATOMIC_FENCE();
+
+		endSequence = ATOMIC_LOAD(&node->resultSequence);
+		ATOMIC_ADD(&node->resultReadersCnt[slotIndex], -1);
+		if (endSequence - (startSequence & ~1u) <= 2)
+			break;
+	}
+}
+
+/**
+* Sets node result to INT value
+*
+* @param node		node
+* @param intValue	integer
+* @return			void
+*/
+EXTERN_DLL_EXPORT void common_result_set_int(Node* node, int64_t intValue)
+{
+	zen_value_t value = { 0 };
+	common_value_set_int(&value, intValue);
+	common_result_publish(node, &value);
+	node->lastResultType = RESULT_TYPE_INT;
+}
+
+/**
+* Sets node result to DOUBLE value
+*
+* @param node			node
+* @param doubleValue	double
+* @return				void
+*/
+EXTERN_DLL_EXPORT void common_result_set_double(Node* node, double doubleValue)
+{
+	zen_value_t value = { 0 };
+	common_value_set_double(&value, doubleValue);
+	common_result_publish(node, &value);
+	node->lastResultType = RESULT_TYPE_DOUBLE;
+}
+
+/**
+* Sets node result to BOOL value
+*
+* @param node		node
+* @param boolValue	0 or 1
+* @return			void
+*/
+EXTERN_DLL_EXPORT void common_result_set_bool(Node* node, int boolValue)
+{
+	zen_value_t value = { 0 };
+	common_value_set_bool(&value, boolValue);
+	common_result_publish(node, &value);
+	node->lastResultType = RESULT_TYPE_BOOL;
+}
+
+/**
+* Sets node result to copy of string. Short strings need no heap allocation
+*
+* @param node		node
+* @param str		zero terminated string
+* @return			void
+*/
+EXTERN_DLL_EXPORT void common_result_set_string(Node* node, const char* str)
+{
+	zen_value_t value = { 0 };
+	common_value_set_string(&value, str);
+	common_result_publish(node, &value);
+	node->lastResultType = RESULT_TYPE_CHAR_ARRAY;
+}
+
+/**
+* Sets node result to copy of blob
+*
+* @param node		node
+* @param data		data to copy
+* @param length		data length in bytes
+* @return			void
+*/
+EXTERN_DLL_EXPORT void common_result_set_blob(Node* node, const void* data, int length)
+{
+	zen_value_t value = { 0 };
+	common_value_set_blob(&value, data, length);
+	common_result_publish(node, &value);
+	node->lastResultType = RESULT_TYPE_BLOB;
+}
+
+/**
+* Gets last published node result, without copying. Use it only where node can't publish meanwhile
+* (eg from node's childs, while they run). Other threads should use common_result_snapshot
+*
+* @param node		node
+* @return			result, valid until node publishes two more results
+*/
+EXTERN_DLL_EXPORT const zen_value_t* common_result_get(Node* node)
+{
+	return &node->resultSlots[(ATOMIC_LOAD(&node->resultSequence) >> 1) & 1];
+}
+
+//*************************************************************************/
+//*********************** End Value Handling ******************************/
+//*************************************************************************/
+
+/**
+* Saves project related data
+*
+* @param project_root	root folder where project resides
+* @param project_id		project unique identifier
+* @return				void
+*/
+EXTERN_DLL_EXPORT void common_init_project(char* project_root, char* project_id, EngineConfiguration engineConfiguration, ptrExecNode execNodeFunct)
+{
+	strncpy(_project_root, project_root, strlen(project_root) + 1);
+	strncpy(_project_id, project_id, strlen(project_id) + 1);
+
+	_execNodeFunct = execNodeFunct;
+	_engineConfiguration = engineConfiguration;
+	pthread_cond_init(&_debug_cond, NULL);
+	pthread_mutex_lock(&_debug_mutex);
+}
+
+/**
+* Finds node by id in node index
 *
-* @param node			triggered node
-
-* @return				void
+* @param	id		node with this Id will be searched
+* @return   Node	node with provided Id, or NULL if it doesn't exist
 */
-EXTERN_DLL_EXPORT void common_pull_event_from_buffer(Node* node)
+EXTERN_DLL_EXPORT Node* common_get_node_by_id(char* id)
 {
-	pthread_mutex_lock(&_event_queue_locks[node->eventQueueLockId]);
+	unsigned slot;
+	if (_nodeIndex == NULL)
+		return NULL;
 
-	node->hasGreenLight = 1;
-	if (node->bufferedEvents.count > 0)
+	slot = hash_string(id) & _nodeIndexMask;
+	while (_nodeIndex[slot] != NULL)
 	{
-		switch (node->lastResultType) 
-		{
-			case RESULT_TYPE_INT:
-				node->lastResult = (int*)popqueue(&node->bufferedEvents);
-				break;
-			
-			case RESULT_TYPE_CHAR_ARRAY:
-				*node->lastResult = (char*)popqueue(&node->bufferedEvents);
-				break;
-		}
-		pthread_cond_signal(&_pause_node_conditions[node->pauseNodeConditionId]);
-		//printf("%d events after pull\n", node->bufferedEventsCount);
+		if (strcmp(id, _nodeIndex[slot]->id) == 0)
+			return _nodeIndex[slot];
+		slot = (slot + 1) & _nodeIndexMask;
 	}
-	pthread_mutex_unlock(&_event_queue_locks[node->eventQueueLockId]);
+	return NULL;
 }
 
 /**
-* Called from event generator (eg OpcClientSubs). Workflow is signalled with current result when buffer is empty and loop is not busy.
-* Otherwise, event is saved to buffer queue.
+* Finds node by id in node index. Id doesn't need to be zero terminated (eg. token from common_str_next_token)
 *
-* @param context	struct with node and result info
-* @return			void
+* @param	id		start of node id
+* @param	length	node id length
+* @return   Node	node with provided Id, or NULL if it doesn't exist
 */
-EXTERN_DLL_EXPORT void common_push_event_to_buffer(void *context)
+EXTERN_DLL_EXPORT Node* common_get_node_by_span(const char* id, int length)
 {
-	struct eventContextParamsStruct *eventParams = context;
-	pthread_mutex_lock(&_event_queue_locks[eventParams->node->eventQueueLockId]);
+	unsigned slot;
+	if (_nodeIndex == NULL)
+		return NULL;
 
-	// Node has not yet been initialized (workflow didn't visit yet our node). In this case ignore it and do not fill any buffer yet
-	// Beware to not come before pausing node. Look at the ZenEngine....
-	if (!eventParams->node->isEventActive)
+	slot = hash_span(id, length) & _nodeIndexMask;
+	while (_nodeIndex[slot] != NULL)
 	{
-		pthread_mutex_unlock(&_event_queue_locks[eventParams->node->eventQueueLockId]);
-		return;
+		if (strncmp(id, _nodeIndex[slot]->id, length) == 0 && _nodeIndex[slot]->id[length] == '\0')
+			return _nodeIndex[slot];
+		slot = (slot + 1) & _nodeIndexMask;
 	}
+	return NULL;
+}
 
-	if (eventParams->node->bufferedEvents.count == 0 && eventParams->node->hasGreenLight)
-	{
-		eventParams->node->hasGreenLight = 0;
-		switch (eventParams->node->lastResultType) 
-		{
-			case RESULT_TYPE_INT:
-				eventParams->node->lastResult = *(int*)eventParams->data;
-				break;
-			
-			case RESULT_TYPE_CHAR_ARRAY:
-				if (eventParams->node->lastResult == NULL)
-					eventParams->node->lastResult = (char**)malloc(sizeof(char*));
-
-				*eventParams->node->lastResult = (char*)eventParams->data;
-				break;
-		}
-		pthread_cond_signal(&_pause_node_conditions[eventParams->node->pauseNodeConditionId]);
-	}
-	else
-	{
-		switch (eventParams->node->lastResultType) 
-		{
-			case RESULT_TYPE_INT:
-				push(&eventParams->node->bufferedEvents, *(int*)eventParams->data);
-				break;
+//******************* Start project arena **********************/
 
-			case RESULT_TYPE_CHAR_ARRAY:
-				push(&eventParams->node->bufferedEvents, (char*)eventParams->data);
-				break;
-		}
-	}
-	//printf("There are %d events after push...\n", eventParams->node->bufferedEventsCount);
-	pthread_mutex_unlock(&_event_queue_locks[eventParams->node->eventQueueLockId]);
+/**
+* Allocates new arena block, big enough for size bytes. Blocks grow, so that arena makes few system allocations
+*
+* @param size		requested size
+* @return			new block, or NULL if allocation fails
+*/
+projectArenaBlock* add_project_arena_block(size_t size)
+{
+	projectArenaBlock* block;
+	size_t blockSize = PROJECT_ARENA_MIN_BLOCK_SIZE;
+
+	if (_project_arena != NULL && _project_arena->size * 2 > blockSize)
+		blockSize = _project_arena->size * 2;
+	if (size > blockSize)
+		blockSize = size;
+
+	block = calloc(1, PROJECT_ARENA_HEADER_SIZE + blockSize);
+	if (block == NULL)
+		return NULL;
+
+	block->size = blockSize;
+	block->used = 0;
+	block->next = _project_arena;
+	_project_arena = block;
+	return block;
 }
 
 /**
-* Inits event queue lock. LockId is saved into nodes eventQueueLockId field
+* Reserves arena space, so that project load, which knows its size, makes single system allocation
 *
-* @param node		node, which lock is going to be inited
+* @param size		bytes to reserve
 * @return			void
 */
-EXTERN_DLL_EXPORT void common_init_event_queue_lock(Node* node)
+EXTERN_DLL_EXPORT void common_project_arena_reserve(size_t size)
 {
-	pthread_mutex_init(&_event_queue_locks[_event_queue_locks_cnt++], NULL);
-	node->eventQueueLockId = _event_queue_locks_cnt - 1;
+	pthread_mutex_lock(&_project_arena_lock);
+	if (_project_arena == NULL || _project_arena->size - _project_arena->used < size)
+		add_project_arena_block(size);
+	pthread_mutex_unlock(&_project_arena_lock);
 }
 
 /**
-* Inits pause condition. Pause condition Id is returned back to node
+* Allocates memory in project arena. Memory is zeroed and aligned for any type.
+* It can't be freed by itself, it's freed with whole arena (common_release_project_arena)
 *
-* @return	int		Pause condition id
+* @param size		bytes to allocate
+* @return			allocated memory, or NULL if allocation fails
 */
-EXTERN_DLL_EXPORT int common_init_pause_condition()
+EXTERN_DLL_EXPORT void* common_project_arena_alloc(size_t size)
 {
-	pthread_cond_init(&_pause_node_conditions[_pause_node_conditions_cnt++], NULL);
-	return _pause_node_conditions_cnt - 1;
+	void* ptr = NULL;
+
+	// Block data is aligned, so rounding sizes keeps all allocations aligned
+	size = (size + 15) & ~(size_t)15;
+	if (size == 0)
+		size = 16;
+
+	pthread_mutex_lock(&_project_arena_lock);
+	if ((_project_arena != NULL && _project_arena->size - _project_arena->used >= size) || add_project_arena_block(size) != NULL)
+	{
+		ptr = (char*)_project_arena + PROJECT_ARENA_HEADER_SIZE + _project_arena->used;
+		_project_arena->used += size;
+	}
+	pthread_mutex_unlock(&_project_arena_lock);
+	return ptr;
 }
 
 /**
-* Signals pause condition.
+* Copies string to project arena
 *
-* @param	pauseNodeConditionId	condition id that is saved in node's condition id field
-* @return	void
+* @param str		string to copy
+* @return			copy of string
 */
-EXTERN_DLL_EXPORT void common_signal_pause_condition(int pauseNodeConditionId)
+EXTERN_DLL_EXPORT char* common_project_arena_strdup(const char* str)
 {
-	pthread_cond_signal(&_pause_node_conditions[pauseNodeConditionId]);
+	size_t length = strlen(str) + 1;
+	char* copy = common_project_arena_alloc(length);
+	if (copy != NULL)
+		memcpy(copy, str, length);
+	return copy;
 }
 
 /**
-* Pauses node main loop.
-*
-* @param	node				node, which loop is going to be paused
-* @param	pause_node_mutex	mutext, required as pthread_cond_wait parameter
+* Gets project arena usage
 *
-* @return	void
+* @param stats		arena stats (output argument)
+* @return			void
 */
-EXTERN_DLL_EXPORT void common_wait_pause_condition(Node* node, pthread_mutex_t *pause_node_mutex)
+EXTERN_DLL_EXPORT void common_get_project_arena_stats(projectArenaStats* stats)
 {
-	pthread_cond_wait(&_pause_node_conditions[node->pauseNodeConditionId], pause_node_mutex);
-}
+	projectArenaBlock* block;
 
-//*************************************************************************/
-//*********************** End Event Buffer Handling   *********************/
-//*************************************************************************/
+	memset(stats, 0, sizeof(projectArenaStats));
+	pthread_mutex_lock(&_project_arena_lock);
+	for (block = _project_arena; block != NULL; block = block->next)
+	{
+		stats->blocksCnt++;
+		stats->size += block->size;
+		stats->used += block->used;
+	}
+	pthread_mutex_unlock(&_project_arena_lock);
+}
 
 /**
-* Saves project related data
+* Frees node resources, that don't live in project arena : buffered events and their chunks, events batch,
+* statistics blocks, argument values set at runtime and heap data of results. Destroys node's locks and conditions
 *
-* @param project_root	root folder where project resides
-* @param project_id		project unique identifier
-* @return				void
+* @param node		node
+* @return			void
 */
-EXTERN_DLL_EXPORT void common_init_project(char* project_root, char* project_id, EngineConfiguration engineConfiguration, ptrExecNode execNodeFunct)
+void release_node_resources(Node* node)
 {
-	strncpy(_project_root, project_root, strlen(project_root) + 1);
-	strncpy(_project_id, project_id, strlen(project_id) + 1);
+	int i;
 
-	_execNodeFunct = execNodeFunct;
-	_engineConfiguration = engineConfiguration;
-	pthread_cond_init(&_debug_cond, NULL);
-	pthread_mutex_lock(&_debug_mutex);
+	if (node->bufferedEvents != NULL)
+		release_buffer(node->bufferedEvents);
+
+	if (node->batchedEvents != NULL)
+	{
+		for (i = 0; i < node->batchedEvents->capacity; i++)
+			common_value_clear(&node->batchedEvents->events[i]);
+		free(node->batchedEvents->events);
+		free(node->batchedEvents);
+		node->batchedEvents = NULL;
+	}
+
+	release_stats_blocks(node);
+
+	// Argument values, that were set at runtime, are heap copies
+	for (i = 0; i < node->argsCnt; i++)
+	{
+		if (node->args[i]->IsValueOwned)
+			free(node->args[i]->Value);
+		free(node->args[i]->RetiredValue);
+	}
+
+	for (i = 0; i < 2; i++)
+	{
+		common_value_clear(&node->resultSlots[i]);
+		free_retired_results(node, i);
+	}
+
+	pthread_mutex_destroy(&node->sync.nodeLock);
+	pthread_cond_destroy(&node->sync.finishCondition);
+	pthread_cond_destroy(&node->sync.pauseCondition);
+	// Only eventable nodes have event queue lock (common_init_event_queue_lock)
+	if (!node->isActionable)
+	{
+		pthread_mutex_destroy(&node->sync.eventQueueLock);
+		pthread_cond_destroy(&node->sync.eventQueueCondition);
+	}
 }
 
 /**
-* Finds node by id
+* Frees all project allocations at once (eg. before project is reloaded). Node list lives in arena,
+* so it's emptied too. Heap resources of listed nodes (see release_node_resources) are freed first.
+* Nodes must not run anymore when arena is released.
+* Not freed here : interned argument keys, which stay valid for next project, lastResult of nodes,
+* which Elements can point to their own data, and engine's own objects (loop locks, scheduler), which engine releases
 *
-* @param	id		node with this Id will be searched
-* @return   Node	node with provided Id
+* @return			void
 */
-EXTERN_DLL_EXPORT Node* common_get_node_by_id(char* id)
+EXTERN_DLL_EXPORT void common_release_project_arena()
 {
+	projectArenaBlock* block;
 	int i;
-	for (i = 0; i < COMMON_NODE_LIST_LENGTH; i++)
+
+	for (i = 0; i < _nodeListLength; i++)
+		release_node_resources(_nodeList[i]);
+
+	pthread_mutex_lock(&_project_arena_lock);
+	while (_project_arena != NULL)
 	{
-		if (strcmp(id, COMMON_NODE_LIST[i]->id) == 0)
-			return COMMON_NODE_LIST[i];
+		block = _project_arena;
+		_project_arena = block->next;
+		free(block);
 	}
-	return NULL;
+	_nodeList = NULL;
+	_nodeListLength = 0;
+	_nodeIndex = NULL;
+	_nodeIndexMask = 0;
+	pthread_mutex_unlock(&_project_arena_lock);
 }
+//******************* End project arena   **********************/
 
 //******************* Start string helpers **********************/
 
 /**
-* Splits string by delimiter.
+* Splits string by delimiter. Tokens array and tokens are allocated together, with single allocation
 *
 * @param str		string to split
 * @param delim		delimiter
@@ -416,47 +1598,82 @@ EXTERN_DLL_EXPORT Node* common_get_node_by_id(char* id)
 */
 EXTERN_DLL_EXPORT void  common_str_split(const char* str, const char* delim, int* numtokens, char*** tokens)
 {
-	char *s = strdup(str);
-
-	int tokens_alloc = 1;
-	int tokens_used = 0;
-	*tokens = calloc(tokens_alloc, sizeof(char*));
-	char *token, *rest = s;
-	while ((token = mystrsep(&rest, delim)) != NULL) {
-		if (tokens_used == tokens_alloc) {
-			tokens_alloc *= 2;
-			*tokens = realloc(*tokens, tokens_alloc * sizeof(char*));
-		}
-
-		(*tokens)[tokens_used++] = strdup(token);
-	}
-	if (tokens_used == 0) {
-		free(*tokens);
-		*tokens = NULL;
-	}
-	else {
-		*tokens = realloc(*tokens, tokens_used * sizeof(char*));
-	}
+	size_t length = strlen(str) + 1;
+	int tokens_cnt = common_str_count_tokens(str, delim), tokens_used = 0;
+	char *s, *token, *rest;
+
+	// Tokens point into copy of string, which is stored right after tokens array
+	*tokens = malloc(tokens_cnt * sizeof(char*) + length);
+	s = (char*)(*tokens + tokens_cnt);
+	memcpy(s, str, length);
+
+	rest = s;
+	while ((token = mystrsep(&rest, delim)) != NULL)
+		(*tokens)[tokens_used++] = token;
 	*numtokens = tokens_used;
-	free(s);
 }
 
 /**
 * Frees splitted string array
 *
 * @param tokens		tokens array
-* @param cnt		tokens array length
+* @param cnt		tokens array length, not needed because array and tokens are single allocation
 * @return           void
 */
 EXTERN_DLL_EXPORT void common_free_splitted_string(char** tokens, int cnt)
 {
-	int i;
-	for (i = 0; i < cnt; i++)
-		free(tokens[i]);
-
+	// Kept for API compatibility with Elements
+	(void)cnt;
 	free(tokens);
 }
 
+/**
+* Gets next token of string, without copying or changing the string. Tokens are the same as with common_str_split,
+* including empty ones between adjacent delimiters and after trailing delimiter
+*
+* @param rest		position in string, set to string start before first call (input / output argument)
+* @param delim		delimiters
+* @param token		token (output argument)
+* @return           1 if token is returned, 0 when there are no more tokens
+*/
+EXTERN_DLL_EXPORT int common_str_next_token(const char** rest, const char* delim, strSpan* token)
+{
+	const char* end;
+
+	if (*rest == NULL)
+		return 0;
+
+	token->start = *rest;
+	end = strpbrk(*rest, delim);
+	if (end == NULL)
+	{
+		token->length = (int)strlen(*rest);
+		*rest = NULL;
+	}
+	else
+	{
+		token->length = (int)(end - *rest);
+		*rest = end + 1;
+	}
+	return 1;
+}
+
+/**
+* Counts tokens of string, same as common_str_split would return
+*
+* @param str		string to split
+* @param delim		delimiters
+* @return           number of tokens
+*/
+EXTERN_DLL_EXPORT int common_str_count_tokens(const char* str, const char* delim)
+{
+	int cnt = 1;
+	const char* p;
+	for (p = strpbrk(str, delim); p != NULL; p = strpbrk(p + 1, delim))
+		cnt++;
+	return cnt;
+}
+
 char* mystrsep(char** stringp, const char* delim)
 {
 	char* start = *stringp;
@@ -487,15 +1704,9 @@ char* mystrsep(char** stringp, const char* delim)
 */
 EXTERN_DLL_EXPORT void common_parse_nodes(Node **nodeArray, char **nodesString, int cnt)
 {
-	int i, j;
+	int i;
 	for (i = 0; i < cnt; i++)
-	{
-		for (j = 0; j < COMMON_NODE_LIST_LENGTH; j++)
-		{
-			if (strcmp(nodesString[i], COMMON_NODE_LIST[j]->id) == 0)
-				nodeArray[i] = COMMON_NODE_LIST[j];
-		}
-	}
+		nodeArray[i] = common_get_node_by_id(nodesString[i]);
 }
 
 /**
@@ -792,83 +2003,440 @@ EXTERN_DLL_EXPORT int common_zip_extract(const char* zip_name, const char* dir,
 //************************ START BUFFER HELPERS* ***************************/
 //**************************************************************************/
 
+/**
+* Inits lock-free buffer. No chunks are allocated until first element is pushed
+*
+* @param buffer		buffer to init
+* @param size		maximum number of elements. Rounded up to power of two
+* @return			void
+*/
 EXTERN_DLL_EXPORT void common_init_buffer(buffer_t *buffer, int size) {
-	buffer->size = size;
-	buffer->start = 0;
-	buffer->count = 0;
-	buffer->element = malloc(sizeof(buffer->element)*size);
-	/* allocated array of void pointers. Same as below */
-	//buffer->element = malloc(sizeof(void *) * size);
+	int maxSize = 2;
+	while (maxSize < size)
+		maxSize <<= 1;
+
+	buffer->maxSize = maxSize;
+	buffer->chunkSize = maxSize < BUFFER_CHUNK_SIZE ? maxSize : BUFFER_CHUNK_SIZE;
+	buffer->lapMask = 2 * buffer->chunkSize - 1;
+	buffer->head = 0;
+	buffer->headChunk = NULL;
+	buffer->tail = 0;
+	buffer->tailChunk = NULL;
+	buffer->spareLock = 0;
+	buffer->spareChunks = NULL;
+	buffer->spareChunksCnt = 0;
+	buffer->chunksCnt = 0;
+	buffer->highWaterMark = 0;
+	buffer->sizeHighWaterMark = 0;
+
+	buffer->overflowPolicy = OVERFLOW_POLICY_DROP_NEWEST;
+	buffer->overflowTimeout = DEFAULT_BUFFER_OVERFLOW_TIMEOUT;
+	buffer->blockedProducersCnt = 0;
+	buffer->droppedCnt = 0;
+	buffer->hasCoalescedElement = 0;
+	memset(&buffer->coalescedElement, 0, sizeof(zen_value_t));
+}
+
+/**
+* Sets what happens with new events when buffer is full
+*
+* @param buffer		buffer
+* @param policy		DROP_NEWEST (default), DROP_OLDEST, BLOCK or COALESCE_LATEST
+* @param timeout	how long producer waits with BLOCK policy, in milliseconds. Default is used when not positive
+* @return			void
+*/
+EXTERN_DLL_EXPORT void common_set_buffer_overflow_policy(buffer_t *buffer, const char* policy, int timeout) {
+	if (strcmp(policy, "DROP_OLDEST") == 0)
+		buffer->overflowPolicy = OVERFLOW_POLICY_DROP_OLDEST;
+	else if (strcmp(policy, "BLOCK") == 0)
+		buffer->overflowPolicy = OVERFLOW_POLICY_BLOCK;
+	else if (strcmp(policy, "COALESCE_LATEST") == 0)
+		buffer->overflowPolicy = OVERFLOW_POLICY_COALESCE_LATEST;
+	else
+		buffer->overflowPolicy = OVERFLOW_POLICY_DROP_NEWEST;
 
+	buffer->overflowTimeout = timeout > 0 ? timeout : DEFAULT_BUFFER_OVERFLOW_TIMEOUT;
 }
 
-int full(buffer_t *buffer) {
-	if (buffer->count == buffer->size) {
-		return 1;
+/**
+* Gets chunk for buffer : buffer's spare chunk, chunk from shared pool or new one, in that order.
+* Only chunks of BUFFER_CHUNK_SIZE are pooled, smaller ones belong to small buffers
+*
+* @param buffer		buffer
+* @return			empty chunk
+*/
+bufferChunk* acquire_buffer_chunk(buffer_t *buffer) {
+	bufferChunk* chunk;
+	int i, size, sizeHighWaterMark;
+
+	while (!ATOMIC_CAS(&buffer->spareLock, 0, 1))
+		sched_yield();
+	chunk = buffer->spareChunks;
+	if (chunk != NULL) {
+		buffer->spareChunks = chunk->next;
+		buffer->spareChunksCnt--;
 	}
-	else {
-		return 0;
+	ATOMIC_STORE(&buffer->spareLock, 0);
+
+	if (chunk == NULL) {
+		if (buffer->chunkSize == BUFFER_CHUNK_SIZE) {
+			pthread_mutex_lock(&_buffer_pool_lock);
+			if (_buffer_pool_cnt > 0)
+				chunk = _buffer_pool[--_buffer_pool_cnt];
+			pthread_mutex_unlock(&_buffer_pool_lock);
+		}
+		if (chunk == NULL) {
+			chunk = malloc(sizeof(bufferChunk) + (buffer->chunkSize - 1) * sizeof(bufferCell));
+			ATOMIC_ADD(&_buffer_chunks_allocated_cnt, 1);
+		}
+
+		size = ATOMIC_ADD(&buffer->chunksCnt, 1) * buffer->chunkSize;
+		sizeHighWaterMark = ATOMIC_LOAD(&buffer->sizeHighWaterMark);
+		while (size > sizeHighWaterMark && !ATOMIC_CAS(&buffer->sizeHighWaterMark, sizeHighWaterMark, size))
+			sizeHighWaterMark = ATOMIC_LOAD(&buffer->sizeHighWaterMark);
 	}
+
+	chunk->next = NULL;
+	for (i = 0; i < buffer->chunkSize; i++)
+		chunk->cells[i].state = 0;
+	return chunk;
 }
 
-int empty(buffer_t *buffer) {
-	if (buffer->count == 0) {
-		return 1;
+/**
+* Returns buffer's chunk to shared pool, or frees it if pool is full
+*
+* @param buffer		buffer
+* @param chunk		chunk, that nobody uses anymore
+* @return			void
+*/
+void pool_buffer_chunk(buffer_t *buffer, bufferChunk* chunk) {
+	ATOMIC_ADD(&buffer->chunksCnt, -1);
+	if (buffer->chunkSize == BUFFER_CHUNK_SIZE) {
+		pthread_mutex_lock(&_buffer_pool_lock);
+		if (_buffer_pool_cnt < BUFFER_POOL_MAX_CHUNKS) {
+			_buffer_pool[_buffer_pool_cnt++] = chunk;
+			chunk = NULL;
+		}
+		pthread_mutex_unlock(&_buffer_pool_lock);
 	}
-	else {
-		return 0;
+	if (chunk != NULL) {
+		free(chunk);
+		ATOMIC_ADD(&_buffer_chunks_allocated_cnt, -1);
 	}
 }
 
-void push(buffer_t *buffer, void *data) {
-	int index;
-	if (full(buffer)) {
-		printf("Buffer overflow\n");
+/**
+* Keeps chunk as buffer's spare. If buffer already has BUFFER_SPARE_CHUNKS spares,
+* chunk is returned to shared pool, or freed if pool is full
+*
+* @param buffer		buffer
+* @param chunk		chunk, that nobody uses anymore
+* @return			void
+*/
+void release_buffer_chunk(buffer_t *buffer, bufferChunk* chunk) {
+	while (!ATOMIC_CAS(&buffer->spareLock, 0, 1))
+		sched_yield();
+	if (buffer->spareChunksCnt < BUFFER_SPARE_CHUNKS) {
+		chunk->next = buffer->spareChunks;
+		buffer->spareChunks = chunk;
+		buffer->spareChunksCnt++;
+		chunk = NULL;
 	}
-	else {
-		index = buffer->start + buffer->count++;
-		if (index >= buffer->size) {
-			index = 0;
+	ATOMIC_STORE(&buffer->spareLock, 0);
+	if (chunk != NULL)
+		pool_buffer_chunk(buffer, chunk);
+}
+
+/**
+* Continues release of chunk, whose last cell is read. Release stops at first cell that is still being read,
+* consumer of that cell continues it when it's done. Last cell is not checked, its consumer starts release
+*
+* @param buffer		buffer
+* @param chunk		chunk
+* @param start		first cell to check
+* @return			void
+*/
+void release_read_buffer_chunk(buffer_t *buffer, bufferChunk* chunk, int start) {
+	int i;
+	for (i = start; i < buffer->chunkSize - 1; i++) {
+		if (!(ATOMIC_LOAD(&chunk->cells[i].state) & BUFFER_CELL_READ) && !(ATOMIC_ADD(&chunk->cells[i].state, BUFFER_CELL_RELEASE) & BUFFER_CELL_READ))
+			return;
+	}
+	release_buffer_chunk(buffer, chunk);
+}
+
+/**
+* Counts elements between positions. Positions skip second half of each lap, so only first chunkSize positions count
+*
+* @param buffer		buffer
+* @param head		producers position
+* @param tail		consumers position
+* @return			number of taken positions, negative if tail was read after head and passed it
+*/
+int get_buffer_count(buffer_t *buffer, unsigned head, unsigned tail) {
+	int laps = (int)((head & ~buffer->lapMask) - (tail & ~buffer->lapMask)) / (int)(buffer->lapMask + 1);
+	return laps * buffer->chunkSize + (int)(head & buffer->lapMask) - (int)(tail & buffer->lapMask);
+}
+
+/**
+* Adds element to the end of buffer. Can be called from many threads at once.
+* Producer that takes last cell of chunk links next chunk
+*
+* @param buffer		buffer
+* @param data		element. It's copied into buffer, which takes over its data on success
+* @return			1 on success, 0 if buffer is full
+*/
+int push(buffer_t *buffer, zen_value_t *data) {
+	bufferChunk *chunk, *nextChunk = NULL;
+	bufferCell* cell;
+	unsigned position, offset;
+	int count, highWaterMark;
+
+	position = ATOMIC_LOAD(&buffer->head);
+	chunk = ATOMIC_LOAD_PTR(&buffer->headChunk);
+	for (;;) {
+		offset = position & buffer->lapMask;
+		// Other producer took last cell of chunk and is linking next one
+		if (offset == (unsigned)buffer->chunkSize) {
+			sched_yield();
+			position = ATOMIC_LOAD(&buffer->head);
+			chunk = ATOMIC_LOAD_PTR(&buffer->headChunk);
+			continue;
+		}
+
+		if (get_buffer_count(buffer, position, ATOMIC_LOAD(&buffer->tail)) >= buffer->maxSize) {
+			if (nextChunk != NULL)
+				release_buffer_chunk(buffer, nextChunk);
+			return 0;
+		}
+
+		// Next chunk is prepared before last cell is taken, so other producers wait for it as short as possible
+		if (offset + 1 == (unsigned)buffer->chunkSize && nextChunk == NULL)
+			nextChunk = acquire_buffer_chunk(buffer);
+
+		// First push links first chunk. Buffer always keeps at least one chunk after that
+		if (chunk == NULL) {
+			chunk = acquire_buffer_chunk(buffer);
+			if (ATOMIC_CAS_PTR(&buffer->headChunk, NULL, chunk))
+				ATOMIC_STORE_PTR(&buffer->tailChunk, chunk);
+			else {
+				release_buffer_chunk(buffer, chunk);
+				position = ATOMIC_LOAD(&buffer->head);
+				chunk = ATOMIC_LOAD_PTR(&buffer->headChunk);
+				continue;
+			}
 		}
-		buffer->element[index] = data;
+
+		if (ATOMIC_CAS(&buffer->head, position, position + 1))
+			break;
+		position = ATOMIC_LOAD(&buffer->head);
+		chunk = ATOMIC_LOAD_PTR(&buffer->headChunk);
+	}
+
+	if (offset + 1 == (unsigned)buffer->chunkSize) {
+		ATOMIC_STORE_PTR(&buffer->headChunk, nextChunk);
+		ATOMIC_STORE(&buffer->head, (position | buffer->lapMask) + 1);
+		ATOMIC_STORE_PTR(&chunk->next, nextChunk);
+		nextChunk = NULL;
 	}
+
+	cell = &chunk->cells[offset];
+	cell->element = *data;
+	ATOMIC_ADD(&cell->state, BUFFER_CELL_WRITTEN);
+
+	count = get_buffer_count(buffer, position + 1, ATOMIC_LOAD(&buffer->tail));
+	highWaterMark = ATOMIC_LOAD(&buffer->highWaterMark);
+	while (count > highWaterMark && !ATOMIC_CAS(&buffer->highWaterMark, highWaterMark, count))
+		highWaterMark = ATOMIC_LOAD(&buffer->highWaterMark);
+
+	if (nextChunk != NULL)
+		release_buffer_chunk(buffer, nextChunk);
+	return 1;
+}
+
+/**
+* Removes element from the start of buffer (FIFO). Can be called from many threads at once
+*
+* @param buffer		buffer
+* @param data		removed element (output argument)
+* @return			1 on success, 0 if buffer is empty
+*/
+int popqueue(buffer_t *buffer, zen_value_t *data) {
+	return popqueue_many(buffer, data, 1);
 }
 
+/**
+* Removes up to maxCnt elements from the start of buffer (FIFO), claiming them with single CAS.
+* Elements are taken from one chunk at once. Can be called from many threads at once.
+* Chunk is released when all its cells are read
+*
+* @param buffer		buffer
+* @param data		removed elements (output argument)
+* @param maxCnt		maximum number of elements to remove
+* @return			number of removed elements
+*/
+int popqueue_many(buffer_t *buffer, zen_value_t *data, int maxCnt) {
+	bufferChunk *chunk, *next;
+	bufferCell* cell;
+	unsigned position, offset;
+	int i, poppedCnt, releaseStart = -1;
+
+	position = ATOMIC_LOAD(&buffer->tail);
+	chunk = ATOMIC_LOAD_PTR(&buffer->tailChunk);
+	for (;;) {
+		offset = position & buffer->lapMask;
+		// Other consumer took last cell of chunk and is moving to next one
+		if (offset == (unsigned)buffer->chunkSize)
+			sched_yield();
+		else {
+			poppedCnt = get_buffer_count(buffer, ATOMIC_LOAD(&buffer->head), position);
+			if (poppedCnt <= 0)
+				return 0;
+			if (poppedCnt > maxCnt)
+				poppedCnt = maxCnt;
+			if (poppedCnt > buffer->chunkSize - (int)offset)
+				poppedCnt = buffer->chunkSize - (int)offset;
+
+			// Chunk is NULL only if it was read before first push linked it
+			if (chunk != NULL && ATOMIC_CAS(&buffer->tail, position, position + poppedCnt))
+				break;
+		}
+		position = ATOMIC_LOAD(&buffer->tail);
+		chunk = ATOMIC_LOAD_PTR(&buffer->tailChunk);
+	}
+
+	// Producer of last cell links next chunk right after it takes the cell
+	if (offset + poppedCnt == (unsigned)buffer->chunkSize) {
+		while ((next = ATOMIC_LOAD_PTR(&chunk->next)) == NULL)
+			sched_yield();
+		ATOMIC_STORE_PTR(&buffer->tailChunk, next);
+		ATOMIC_STORE(&buffer->tail, (position | buffer->lapMask) + 1);
+	}
+
+	for (i = 0; i < poppedCnt; i++) {
+		cell = &chunk->cells[offset + i];
+		// Cell is taken by producer, which is about to write it
+		while (!(ATOMIC_LOAD(&cell->state) & BUFFER_CELL_WRITTEN))
+			sched_yield();
+		data[i] = cell->element;
+	}
 
-void * popqueue(buffer_t *buffer) {
-	void * element;
-	if (empty(buffer)) {
-		printf("Buffer underflow\n");
-		return "0";
+	if (offset + poppedCnt == (unsigned)buffer->chunkSize) {
+		for (i = 0; i < poppedCnt - 1; i++)
+			ATOMIC_ADD(&chunk->cells[offset + i].state, BUFFER_CELL_READ);
+		release_read_buffer_chunk(buffer, chunk, 0);
 	}
 	else {
-		/* FIFO implementation */
-		element = buffer->element[buffer->start];
-		buffer->start++;
-		buffer->count--;
-		if (buffer->start == buffer->size) {
-			buffer->start = 0;
+		// Release stops at first cell that is not read yet, so at most one of these cells can have release waiting
+		for (i = 0; i < poppedCnt; i++) {
+			if (ATOMIC_ADD(&chunk->cells[offset + i].state, BUFFER_CELL_READ) & BUFFER_CELL_RELEASE)
+				releaseStart = offset + i + 1;
 		}
+		if (releaseStart >= 0)
+			release_read_buffer_chunk(buffer, chunk, releaseStart);
+	}
+	return poppedCnt;
+}
 
-		return element;
+/**
+* Frees buffered elements, coalesced element and all chunks of buffer. Chunks go back to shared pool.
+* Nobody may push or pop meanwhile
+*
+* @param buffer		buffer
+* @return			void
+*/
+void release_buffer(buffer_t *buffer) {
+	zen_value_t element;
+	bufferChunk* chunk;
+
+	while (popqueue(buffer, &element))
+		common_value_clear(&element);
+	if (buffer->hasCoalescedElement) {
+		common_value_clear(&buffer->coalescedElement);
+		buffer->hasCoalescedElement = 0;
 	}
+
+	// Drained buffer holds only its current chunk and spares
+	if (buffer->headChunk != NULL)
+		pool_buffer_chunk(buffer, buffer->headChunk);
+	while (buffer->spareChunks != NULL) {
+		chunk = buffer->spareChunks;
+		buffer->spareChunks = chunk->next;
+		pool_buffer_chunk(buffer, chunk);
+	}
+	buffer->headChunk = NULL;
+	buffer->tailChunk = NULL;
+	buffer->spareChunksCnt = 0;
 }
 
-void * popstack(buffer_t *buffer) {
-	int index;
-	if (empty(buffer)) {
-		printf("Buffer underflow\n");
-		return "0";
+/**
+* Gets absolute (wall clock) time after given timeout, as required by pthread_cond_timedwait
+*
+* @param ts			absolute time (output argument)
+* @param timeout	timeout in milliseconds
+* @return			void
+*/
+void get_abs_time(struct timespec* ts, int timeout) {
+#if defined(_WIN32)
+	timespec_get(ts, TIME_UTC);
+#else
+	clock_gettime(CLOCK_REALTIME, ts);
+#endif
+	ts->tv_sec += timeout / 1000;
+	ts->tv_nsec += (timeout % 1000) * 1000000L;
+	if (ts->tv_nsec >= 1000000000L) {
+		ts->tv_sec++;
+		ts->tv_nsec -= 1000000000L;
 	}
-	else {
-		/* LIFO implementation */
-		index = buffer->start + buffer->count - 1;
-		if (index >= buffer->size) {
-			index = buffer->count - buffer->size - 1;
-		}
-		buffer->count--;
-		return buffer->element[index];
+}
+
+/**
+* Checks if buffer has elements. Element can be taken, but not written by producer yet
+*
+* @param buffer		buffer
+* @return			1 if element can be removed, otherwise 0
+*/
+int has_elements(buffer_t *buffer) {
+	unsigned tail = ATOMIC_LOAD(&buffer->tail);
+	return get_buffer_count(buffer, ATOMIC_LOAD(&buffer->head), tail) > 0;
+}
+
+/**
+* Gets event buffer occupancy of node. Values are read without locking, so they are approximate.
+* Nodes without event buffer report zeros
+*
+* @param node		node with event buffer
+* @param stats		buffer stats (output argument)
+* @return			void
+*/
+EXTERN_DLL_EXPORT void common_get_event_buffer_stats(Node* node, eventBufferStats* stats) {
+	buffer_t* buffer = node->bufferedEvents;
+	unsigned tail;
+	if (buffer == NULL)
+	{
+		memset(stats, 0, sizeof(eventBufferStats));
+		return;
 	}
+	stats->size = ATOMIC_LOAD(&buffer->chunksCnt) * buffer->chunkSize;
+	stats->maxSize = buffer->maxSize;
+	tail = ATOMIC_LOAD(&buffer->tail);
+	stats->count = get_buffer_count(buffer, ATOMIC_LOAD(&buffer->head), tail);
+	stats->highWaterMark = ATOMIC_LOAD(&buffer->highWaterMark);
+	stats->sizeHighWaterMark = ATOMIC_LOAD(&buffer->sizeHighWaterMark);
+	stats->droppedCnt = ATOMIC_LOAD(&buffer->droppedCnt);
+}
+
+/**
+* Gets usage of shared buffer chunk pool
+*
+* @param stats		pool stats (output argument)
+* @return			void
+*/
+EXTERN_DLL_EXPORT void common_get_buffer_pool_stats(bufferPoolStats* stats) {
+	pthread_mutex_lock(&_buffer_pool_lock);
+	stats->pooledChunksCnt = _buffer_pool_cnt;
+	pthread_mutex_unlock(&_buffer_pool_lock);
+	stats->allocatedChunksCnt = ATOMIC_LOAD(&_buffer_chunks_allocated_cnt);
 }
 //**************************************************************************/
 //************************ END BUFFER HELPERS ******************************/
@@ -904,6 +2472,8 @@ EXTERN_DLL_EXPORT void common_json_dump_table(Tables *tables)
 				case RESULT_TYPE_CHAR_ARRAY:
 					cJSON_AddItemToObject(json_device, tables->tables[k]->cols[j]->name, cJSON_CreateString(tables->tables[k]->cols[j]->rows[i]));
 					break;
+				default:
+					break;
 				}
 			}
 			cJSON_AddItemToArray(events, json_device);
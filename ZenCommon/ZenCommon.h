@@ -22,7 +22,9 @@
 #pragma once
 #include "pthread.h"
 #include <stdio.h>
+#include <stdint.h>
 #include "zip.h"
+#include "ZenAtomic.h"
 
 #if defined (__cplusplus)
 #if defined (_WIN32)
@@ -59,92 +61,406 @@ typedef enum
 	RESULT_TYPE_BOOL,
 	RESULT_TYPE_DOUBLE,
 	RESULT_TYPE_CHAR_ARRAY,
-	RESULT_TYPE_JSON_STRING
+	RESULT_TYPE_JSON_STRING,
+	// Last result points to eventsBatch (__EVENTS_BATCH_SIZE__ property)
+	RESULT_TYPE_EVENTS_BATCH,
+	// Last result points to pointer to blob data, same as for CHAR_ARRAY. Length is read with common_result_get
+	RESULT_TYPE_BLOB
 } result_type;
 
+// Strings shorter than this (and blobs up to this length) are stored inside value, without heap allocation
+#define VALUE_INLINE_SIZE 16
+
+/* Typed value of node result or event.
+* Zero filled value is empty INT value. Value must be zero filled or cleared before first use.
+* Ownership rules:
+*	+ common_value_set_string / common_value_set_blob copy data. Short data is stored inline, longer is owned heap copy
+*	+ common_value_take_string takes over malloc-ed string, which is freed by value
+*	+ common_value_set_string_ref / common_value_set_blob_ref only borrow data. Caller keeps it alive while value is used
+* Owned data is freed when value is set again or cleared (common_value_clear).
+*/
+typedef struct
+{
+	result_type type;
+	// Length of string (without terminating zero) or blob, in bytes
+	int length;
+	unsigned char isOwned;
+	unsigned char isInline;
+	union
+	{
+		int64_t intValue;
+		double doubleValue;
+		int boolValue;
+		const void* data;
+		char inlineData[VALUE_INLINE_SIZE];
+	} as;
+} zen_value_t;
+
+// How engine executes nodes
+typedef enum
+{
+	// Each node gets its own thread, that is paused between executions
+	EXECUTION_MODE_THREAD_PER_NODE,
+	// Fixed number of workers execute ready nodes pulled from run queue
+	EXECUTION_MODE_WORKER_POOL
+} execution_mode;
+
+// Node state machine. Status is changed and read with atomic operations (ZenAtomic.h)
+typedef enum
+{
+	NODE_STATUS_IDLE,
+	NODE_STATUS_RUNNING,
+	NODE_STATUS_ARRIVED,
+	NODE_STATUS_STOPPED
+} node_status;
+
+// Node operator, resolved from OPERATOR property when nodes are loaded
+typedef enum
+{
+	// "&" : all parents conditions must be met
+	NODE_OPERATOR_AND,
+	// "||" : at least one parent condition must be met
+	NODE_OPERATOR_OR
+} node_operator;
+
 typedef struct
 {
 	char *Key;
-	char *Value;
+	// Value that fits into current buffer is overwritten in place, longer one is published as new heap copy (see common_set_node_arg)
+	char * volatile Value;
+	// Size of Value buffer, and 1 if it's heap copy (initial value lives in project arena)
+	int ValueCapacity;
+	int IsValueOwned;
+	// Previous heap copy, freed on next reallocation, because readers can still hold it
+	char* RetiredValue;
+	// Interned key (common_intern_key)
+	int KeyHandle;
+	// Sequence number of value and typed values. It's odd while setter is changing them
+	volatile int Version;
+	// Typed values, parsed from Value whenever value is set
+	int IntValue;
+	double DoubleValue;
+	int BoolValue;
 }nodeArgs;
 
-struct Implementation {
-	char id[50];
-	char fileName[50];
-	char type[10];
-	void *hDLL;
-	char params[512];
-};
+#define CACHE_LINE_SIZE 64
+
+// What happens with new event, when event buffer is full (__BUFFER_OVERFLOW_POLICY__ property)
+typedef enum
+{
+	// New event is dropped (DROP_NEWEST)
+	OVERFLOW_POLICY_DROP_NEWEST,
+	// Oldest buffered event is dropped to make space for new one (DROP_OLDEST)
+	OVERFLOW_POLICY_DROP_OLDEST,
+	// Producer waits for free space at most __BUFFER_OVERFLOW_TIMEOUT__ ms, then new event is dropped (BLOCK)
+	OVERFLOW_POLICY_BLOCK,
+	// New event is kept aside and replaced by every next event, until buffer has space again (COALESCE_LATEST)
+	OVERFLOW_POLICY_COALESCE_LATEST
+} overflow_policy;
+
+#define DEFAULT_BUFFER_OVERFLOW_TIMEOUT 1000
+
+// Number of cells in one buffer chunk. Buffers grow and shrink by whole chunks
+#define BUFFER_CHUNK_SIZE 256
+// How many free chunks are kept in shared pool for reuse, instead of being freed
+#define BUFFER_POOL_MAX_CHUNKS 256
+// How many drained chunks buffer keeps for its own reuse, before it returns them to shared pool
+#define BUFFER_SPARE_CHUNKS 4
+
+// Cell state bits
+// Producer has written element
+#define BUFFER_CELL_WRITTEN 1
+// Consumer has read element
+#define BUFFER_CELL_READ 2
+// Chunk release is waiting for consumer of this cell, which continues it
+#define BUFFER_CELL_RELEASE 4
+
+typedef struct
+{
+	volatile unsigned state;
+	zen_value_t element;
+} bufferCell;
+
+// Chunk of cells. Chunks are linked in order in which they are filled
+typedef struct bufferChunk
+{
+	struct bufferChunk* volatile next;
+	bufferCell cells[1];
+} bufferChunk;
 
+/* Lock-free multi producer / multi consumer queue of linked chunks (segmented queue, as crossbeam's SegQueue).
+* Positions advance through laps of 2 * chunkSize positions. First chunkSize positions of lap map to cells
+* of current chunk, position chunkSize means that thread which took last cell is linking next chunk.
+* Buffer grows by appending chunk when producer takes last cell of current one, so elements are never moved
+* and nobody waits for resize. Chunk is released when all its cells are read : consumer of last cell starts
+* release and consumers that are still reading pass it on (BUFFER_CELL_RELEASE). Released chunks are kept
+* as buffer spares (up to BUFFER_SPARE_CHUNKS), so bursts don't go through shared pool, the rest go to pool.
+* Number of elements is limited to maxSize (__EVENTS_BUFFER_LENGTH__ rounded up to power of two),
+* checked before position is taken, so concurrent producers can exceed it by few elements.
+* Head (producers) and tail (consumers) are on separate cache lines,
+* so event generators don't invalidate line that workflow thread reads and vice versa.
+*/
 struct buffer {
-	int size;
-	int start;
-	//int end;  // position of last element
-	/* Tracking start and end of buffer would waste
-	* one position. A full buffer would always have
-	* to leave last position empty or otherwise
-	* it would look empty. Instead this buffer uses
-	* count to track if buffer is empty or full
-	*/
-	int count; // number of elements in buffer
-			   /* Two ways to make buffer element type opaque
-			   * First is by using typedef for the element
-			   * pointer. Second is by using void pointer.
-			   */
-			   /* different types of buffer:
-			   int *element;   // array of integers
-			   char *element;  // array of characters
-			   void *element;  // array of void type (could cast to int, char, etc)
-			   char **element; //array of char pointers (array of strings)
-			   void **element; // array of void pointers
-			   Choosing array of void pointers since it's the most flexible */
-	void **element;
+	volatile unsigned head;
+	bufferChunk* volatile headChunk;
+	char headPadding[CACHE_LINE_SIZE - sizeof(unsigned) - sizeof(bufferChunk*)];
+	volatile unsigned tail;
+	bufferChunk* volatile tailChunk;
+	char tailPadding[CACHE_LINE_SIZE - sizeof(unsigned) - sizeof(bufferChunk*)];
+	int maxSize;
+	int chunkSize;
+	unsigned lapMask;
+	volatile int spareLock;
+	bufferChunk* spareChunks;
+	int spareChunksCnt;
+	volatile int chunksCnt;
+	volatile int highWaterMark;
+	volatile int sizeHighWaterMark;
+	overflow_policy overflowPolicy;
+	int overflowTimeout;
+	volatile int blockedProducersCnt;
+	volatile int droppedCnt;
+	volatile int hasCoalescedElement;
+	zen_value_t coalescedElement;
 };
 
 typedef struct buffer buffer_t;
 
+/* Buffered events, delivered to triggering node at once.
+* Events are owned by batch and stay valid until next batch is delivered
+*/
+typedef struct
+{
+	// Type of events pushed with common_push_event_to_buffer (node's own result type)
+	result_type eventsType;
+	int eventsCnt;
+	int capacity;
+	zen_value_t* events;
+} eventsBatch;
+
+// Event buffer occupancy, see common_get_event_buffer_stats
+typedef struct
+{
+	// Cells of chunks held by buffer, including its spare chunks
+	int size;
+	// Maximum number of cells (__EVENTS_BUFFER_LENGTH__ rounded up to power of two)
+	int maxSize;
+	// Buffered events
+	int count;
+	// Most events ever buffered at once
+	int highWaterMark;
+	// Most cells ever allocated at once
+	int sizeHighWaterMark;
+	// Events dropped by overflow policy
+	int droppedCnt;
+} eventBufferStats;
+
+// Shared buffer chunk pool usage, see common_get_buffer_pool_stats
+typedef struct
+{
+	// Chunks currently allocated by all buffers, including pooled ones
+	int allocatedChunksCnt;
+	// Free chunks waiting in pool
+	int pooledChunksCnt;
+} bufferPoolStats;
+
+// Smallest block of project arena. Bigger blocks are allocated for bigger requests
+#define PROJECT_ARENA_MIN_BLOCK_SIZE 65536
+
+// Project arena usage, see common_get_project_arena_stats
+typedef struct
+{
+	// System allocations made by arena
+	int blocksCnt;
+	// Allocated bytes in all blocks
+	size_t size;
+	// Used bytes in all blocks
+	size_t used;
+} projectArenaStats;
+
+// Token of string (common_str_next_token). It points into tokenized string, so it's not zero terminated
+typedef struct
+{
+	const char* start;
+	int length;
+} strSpan;
+
+// Latency histogram is log-linear (HDR style) : each power of two range of nanoseconds is split into
+// NODE_STATS_SUB_BUCKETS linear buckets, so recorded values keep about 12% precision
+#define NODE_STATS_SUB_BUCKET_BITS 3
+#define NODE_STATS_SUB_BUCKETS (1 << NODE_STATS_SUB_BUCKET_BITS)
+// Values up to 2^40 ns (about 18 minutes) are bucketed, longer ones are counted in last bucket
+#define NODE_STATS_GROUPS (40 - NODE_STATS_SUB_BUCKET_BITS + 1)
+#define NODE_STATS_BUCKETS (NODE_STATS_GROUPS * NODE_STATS_SUB_BUCKETS)
+
+// Latency histogram. It has single writer, readers can read it while it's written (see common_histogram_record)
+typedef struct
+{
+	volatile uint64_t cnt;
+	volatile uint64_t totalNs;
+	volatile uint64_t maxNs;
+	volatile uint32_t buckets[NODE_STATS_BUCKETS];
+} latencyHistogram;
+
+// Node execution statistics, merged from all threads that executed node (see common_get_node_stats)
+typedef struct
+{
+	// Executions and executions that ended with error code
+	uint64_t fireCnt;
+	uint64_t errorCnt;
+	// Execution time
+	uint64_t executionTotalNs;
+	uint64_t executionMaxNs;
+	uint64_t executionP50Ns;
+	uint64_t executionP99Ns;
+	uint64_t executionP999Ns;
+	// Time from node becoming ready (started, signalled or enqueued) to start of execution
+	uint64_t queueWaitCnt;
+	uint64_t queueWaitTotalNs;
+	uint64_t queueWaitMaxNs;
+} nodeStats;
+
+// Default number of records in trace ring of each thread. Oldest records are overwritten
+#define TRACE_DEFAULT_RECORDS_PER_THREAD 16384
+#define TRACE_DEFAULT_FILE "trace.json"
+
+// Execution trace record types (see common_trace_end and common_trace_instant)
+typedef enum
+{
+	// Durations
+	TRACE_NODE_EXECUTION,
+	TRACE_LOOP_LOCK,
+	TRACE_NODE_LOCK,
+	TRACE_PAUSE_WAIT,
+	// Instants
+	TRACE_PAUSE_SIGNAL,
+	TRACE_EVENT_PUSH,
+	TRACE_EVENT_PULL
+} trace_type;
+
+struct ImplementationVTable;
+struct nodeStatsBlock;
+
+// Heap data of overwritten result slot, that readers were still copying (see common_result_publish)
+typedef struct retiredResult
+{
+	struct retiredResult* next;
+	void* data;
+} retiredResult;
+
+#define NODE_ID_LENGTH 50
+#define NODE_ERROR_MESSAGE_LENGTH 512
+
+// Synchronization objects of one node. They are embedded in node, so there are as many of them as there are nodes
+typedef struct
+{
+	// Node lock and condition, signalled when node stops running
+	pthread_mutex_t nodeLock;
+	pthread_cond_t finishCondition;
+	// Node thread waits on it between runs (thread per node mode)
+	pthread_cond_t pauseCondition;
+	// Event queue lock and condition, used only on slow paths : blocked producers and coalesced events
+	pthread_mutex_t eventQueueLock;
+	pthread_cond_t eventQueueCondition;
+} nodeSyncObjects;
+
+// Node fields are ordered by access frequency. Fields used on every fire come first, so they share
+// first cache lines. Parents dependency counters are kept in engine's scheduling arrays, and
+// cold data (id, implementation id, error message, event buffer) is kept out of line
 typedef struct Node
 {
-	char  id[50];
-	char  implementationId[50];
-	int  isEventActive;
-	void *implementation;
-	int trueParentsCnt;
-	int falseParentsCnt;
+	int index;
+	volatile int status;
+	int isConditionMet;
+	int publishedConditionMet;
+	node_operator nodeOperator;
+	int isStarted;
+	int isInitialized;
+	int isActionable;
+	volatile int hasGreenLight;
+	int isEventActive;
+	int unregisterEvent;
+	int loopLockId;
+	int isQueued;
+	int runningWaitsCnt;
+	volatile int statusWaitersCnt;
 	int trueChildsCnt;
 	int falseChildsCnt;
+	int trueParentsCnt;
+	int falseParentsCnt;
 	int disconnectedNodesCnt;
-	nodeArgs **args;
-	int argsCnt;
-	int isStarted;
-	char  status[10];
-	struct Node** ptrTrueChilds;
-	struct Node** ptrFalseChilds;
-	struct Node** ptrTrueParents;
-	struct Node** ptrFalseParents;
-	struct Node** disconnectedNodes;
-	int isConditionMet;
-	char nodeOperator[3];
-	time_t started;
-	int unregisterEvent;
-	int errorCode;
-	char errorMessage[512];
+	int nodesToTriggerCnt;
+	struct ImplementationVTable* vtable;
+	void *implementation;
 	void* implementationContext;
-	int isInitialized;
+	struct Node* nextQueued;
+	// Monotonic time when node became ready, 0 when it isn't waiting. Set by waking thread, taken by executing thread
+	volatile uint64_t readyNs;
+	// Execution statistics, one block per thread that executed node
+	struct nodeStatsBlock* statsBlocks;
+	// Relations are rows of node indices in engine's CSR relation arrays
+	const uint32_t* trueChilds;
+	const uint32_t* falseChilds;
+	const uint32_t* trueParents;
+	const uint32_t* falseParents;
+	struct Node** disconnectedNodes;
+	struct Node** nodesToTrigger;
+	// Compatibility view of result : INT events as (intptr_t) value, CHAR_ARRAY events as char**
 	void** lastResult;
 	result_type lastResultType;
-	struct Node** nodesToTrigger;
-	int nodesToTriggerCnt;
-	buffer_t bufferedEvents;
-	int isActionable;
-	int loopLockId;
-	int nodeLockId;
-	int pauseNodeConditionId;
-	int eventQueueLockId;
-	int hasGreenLight;
+	// Typed result, published with seqlock over two slots (see common_result_publish)
+	volatile unsigned resultSequence;
+	// Readers of each slot. Writer frees heap data of slot only when slot has no readers
+	volatile int resultReadersCnt[2];
+	zen_value_t resultSlots[2];
+	retiredResult* retiredResults[2];
+	nodeSyncObjects sync;
+	// Cold data
+	buffer_t* bufferedEvents;
+	eventsBatch* batchedEvents;
+	nodeArgs **args;
+	int argsCnt;
+	int errorCode;
+	time_t started;
+	char* id;
+	char* implementationId;
+	char* errorMessage;
 } Node;
 
+//Element entry points
+typedef int(*ptrOnImplementationInit)(char*);
+typedef Node**(*ptrOnGetNodesToExecute)(Node*, int*);
+typedef int(*ptrOnNodeInit)(Node*);
+typedef int(*ptrOnNodePreInit)(Node*);
+typedef int(*ptrExecuteAction)(Node*);
+typedef int(*ptrSubscribeNodeToEvent)(Node*);
+typedef int(*ptrOnNodeComplete)(Node*);
+typedef int(*ptrOnNodeEvent)(Node*, char*);
+
+// Element entry points, resolved once when implementation is loaded. Missing entry points are NULL
+typedef struct ImplementationVTable
+{
+	ptrOnImplementationInit onImplementationInit;
+	ptrOnNodePreInit onNodePreInit;
+	ptrOnNodeInit onNodeInit;
+	ptrExecuteAction executeAction;
+	ptrSubscribeNodeToEvent onSubscribeNodeToEvent;
+	ptrOnGetNodesToExecute getNodesToExecute;
+	ptrOnNodeEvent onNodeEvent;
+	ptrOnNodeComplete onNodeComplete;
+} ImplementationVTable;
+
+struct Implementation {
+	char id[50];
+	char fileName[50];
+	char type[10];
+	void *hDLL;
+	char params[512];
+	ImplementationVTable vtable;
+};
+
 typedef char*(*ptrExecNode)(int(*OnExecNode)(Node*));
+typedef void(*ptrSignalNode)(Node*);
 
 struct eventContextParamsStruct {
 	Node* node;
@@ -170,6 +486,13 @@ typedef struct EngineConfiguration
 	char projectRoot[256];
 	char* netCorePath;
 	char* updatedBy;
+	execution_mode executionMode;
+	int workersCnt;
+	char* metricsAddress;
+	int metricsPort;
+	int isTraceEnabled;
+	int traceRecordsPerThread;
+	char* traceFile;
 } EngineConfiguration;
 EngineConfiguration engineConfiguration;
 
@@ -200,22 +523,79 @@ typedef struct
 #define COMMON_ENGINE_CONFIGURATION GetEngineConfiguration()
 
 char* mystrsep(char** stringp, const char* delim);
-void push(buffer_t *buffer, void *data);
-void * popqueue(buffer_t *buffer);
-void * popstack(buffer_t *buffer);
+int push(buffer_t *buffer, zen_value_t *data);
+int popqueue(buffer_t *buffer, zen_value_t *data);
+int popqueue_many(buffer_t *buffer, zen_value_t *data, int maxCnt);
+int has_elements(buffer_t *buffer);
+void deliver_buffered_event(Node* node);
+int take_buffered_events(Node* node, zen_value_t* events, int maxCnt);
+void get_abs_time(struct timespec* ts, int timeout);
+void push_with_overflow_policy(Node* node, zen_value_t* event);
+void signal_node(Node* node);
+unsigned hash_string(const char* str);
+unsigned hash_span(const char* str, int length);
+void parse_node_arg(nodeArgs* arg);
+void read_node_arg(nodeArgs* arg, int* intValue, double* doubleValue, int* boolValue);
+void copy_value_data(zen_value_t* value, const void* data, int length, int extraCnt);
+void release_buffer(buffer_t *buffer);
+void release_stats_blocks(Node* node);
+void free_retired_results(Node* node, int slotIndex);
 
 EXTERN_DLL_EXPORT void common_wait_debug_signal();
 EXTERN_DLL_EXPORT void common_signal_debug_condition();
 EXTERN_DLL_EXPORT unsigned common_is_debug_mode_enabled();
 EXTERN_DLL_EXPORT void common_set_debug_mode(unsigned isDebugMode);
 EXTERN_DLL_EXPORT void common_init_buffer(buffer_t *buffer, int size);
-EXTERN_DLL_EXPORT void common_signal_pause_condition(int pauseNodeConditionId);
+EXTERN_DLL_EXPORT void common_set_buffer_overflow_policy(buffer_t *buffer, const char* policy, int timeout);
+EXTERN_DLL_EXPORT void common_get_event_buffer_stats(Node* node, eventBufferStats* stats);
+EXTERN_DLL_EXPORT void common_get_buffer_pool_stats(bufferPoolStats* stats);
+EXTERN_DLL_EXPORT void common_signal_pause_condition(Node* node);
 EXTERN_DLL_EXPORT void common_wait_pause_condition(Node* node, pthread_mutex_t *pause_node_mutex);
-EXTERN_DLL_EXPORT int common_init_pause_condition();
+EXTERN_DLL_EXPORT void common_init_pause_condition(Node* node);
 EXTERN_DLL_EXPORT void common_init_event_queue_lock(Node* node);
+EXTERN_DLL_EXPORT void common_init_events_batch(Node* node, int batchSize);
 EXTERN_DLL_EXPORT void common_pull_event_from_buffer(Node* node);
 EXTERN_DLL_EXPORT void common_push_event_to_buffer(void *context);
+EXTERN_DLL_EXPORT void common_push_value_to_buffer(Node* node, zen_value_t* value);
+EXTERN_DLL_EXPORT void common_value_clear(zen_value_t* value);
+EXTERN_DLL_EXPORT void common_value_move(zen_value_t* destination, zen_value_t* source);
+EXTERN_DLL_EXPORT void common_value_set_int(zen_value_t* value, int64_t intValue);
+EXTERN_DLL_EXPORT void common_value_set_double(zen_value_t* value, double doubleValue);
+EXTERN_DLL_EXPORT void common_value_set_bool(zen_value_t* value, int boolValue);
+EXTERN_DLL_EXPORT void common_value_set_string(zen_value_t* value, const char* str);
+EXTERN_DLL_EXPORT void common_value_set_string_ref(zen_value_t* value, const char* str, int length);
+EXTERN_DLL_EXPORT void common_value_take_string(zen_value_t* value, char* str);
+EXTERN_DLL_EXPORT void common_value_set_blob(zen_value_t* value, const void* data, int length);
+EXTERN_DLL_EXPORT void common_value_set_blob_ref(zen_value_t* value, const void* data, int length);
+EXTERN_DLL_EXPORT const void* common_value_get_data(const zen_value_t* value);
+EXTERN_DLL_EXPORT const char* common_value_get_string(const zen_value_t* value);
+EXTERN_DLL_EXPORT void common_result_set_int(Node* node, int64_t intValue);
+EXTERN_DLL_EXPORT void common_result_set_double(Node* node, double doubleValue);
+EXTERN_DLL_EXPORT void common_result_set_bool(Node* node, int boolValue);
+EXTERN_DLL_EXPORT void common_result_set_string(Node* node, const char* str);
+EXTERN_DLL_EXPORT void common_result_set_blob(Node* node, const void* data, int length);
+EXTERN_DLL_EXPORT const zen_value_t* common_result_get(Node* node);
+EXTERN_DLL_EXPORT void common_result_publish(Node* node, zen_value_t* value);
+EXTERN_DLL_EXPORT uint64_t common_get_time_ns();
+EXTERN_DLL_EXPORT void common_stats_record_execution(Node* node, uint64_t executionNs, int isError);
+EXTERN_DLL_EXPORT void common_stats_record_queue_wait(Node* node, uint64_t queueWaitNs);
+EXTERN_DLL_EXPORT void common_stats_reset_queue_wait_max(Node* node);
+EXTERN_DLL_EXPORT void common_stats_begin_measurement();
+EXTERN_DLL_EXPORT int common_stats_is_measuring();
+EXTERN_DLL_EXPORT void common_get_node_stats(Node* node, nodeStats* stats);
+EXTERN_DLL_EXPORT void common_histogram_record(latencyHistogram* histogram, uint64_t valueNs);
+EXTERN_DLL_EXPORT uint64_t common_histogram_percentile(const latencyHistogram* histogram, double percentile);
+EXTERN_DLL_EXPORT void common_trace_init(int isEnabled, int recordsPerThread, const char* file);
+EXTERN_DLL_EXPORT uint64_t common_trace_begin();
+EXTERN_DLL_EXPORT void common_trace_end(trace_type type, Node* node, uint64_t beginTicks);
+EXTERN_DLL_EXPORT void common_trace_instant(trace_type type, Node* node);
+EXTERN_DLL_EXPORT void common_trace_request_dump();
+EXTERN_DLL_EXPORT int common_trace_dump(const char* file);
+EXTERN_DLL_EXPORT const char* common_trace_get_file();
+EXTERN_DLL_EXPORT void common_result_snapshot(Node* node, zen_value_t* snapshot);
 EXTERN_DLL_EXPORT void common_init_project(char* project_root, char* project_id, EngineConfiguration engineConfiguration, ptrExecNode execNodeFunct);
+EXTERN_DLL_EXPORT void common_set_signal_node_callback(ptrSignalNode signalNodeFunct);
+EXTERN_DLL_EXPORT const char* common_get_node_status_string(Node* node);
 EXTERN_DLL_EXPORT char* COMMON_PROJECT_ROOT;
 EXTERN_DLL_EXPORT char* COMMON_PROJECT_ID;
 EXTERN_DLL_EXPORT Node** COMMON_NODE_LIST;
@@ -225,14 +605,29 @@ EXTERN_DLL_EXPORT void common_exec_node(Node* node);
 EXTERN_DLL_EXPORT int  executeAction(Node* node);
 EXTERN_DLL_EXPORT char*  common_get_node_arg(Node* node, char* key);
 EXTERN_DLL_EXPORT void  common_set_node_arg(Node* node, char* key, char* value);
+EXTERN_DLL_EXPORT int common_intern_key(const char* key);
+EXTERN_DLL_EXPORT nodeArgs* common_create_node_arg(const char* key, const char* value);
+EXTERN_DLL_EXPORT nodeArgs* common_get_node_arg_by_handle(Node* node, int keyHandle);
+EXTERN_DLL_EXPORT char* common_get_node_arg_string(Node* node, int keyHandle);
+EXTERN_DLL_EXPORT int common_get_node_arg_int(Node* node, int keyHandle);
+EXTERN_DLL_EXPORT double common_get_node_arg_double(Node* node, int keyHandle);
+EXTERN_DLL_EXPORT int common_get_node_arg_bool(Node* node, int keyHandle);
 EXTERN_DLL_EXPORT Node* common_get_node_by_id(char* id);
+EXTERN_DLL_EXPORT Node* common_get_node_by_span(const char* id, int length);
 EXTERN_DLL_EXPORT void common_parse_nodes(Node** childsArr, char **childs, int cnt);
 EXTERN_DLL_EXPORT int common_is_string_in_array(char** arr, char* str, int arrLength);
 EXTERN_DLL_EXPORT void  common_str_split(const char* str, const char* delim, int* numtokens, char*** tokens);
 EXTERN_DLL_EXPORT void common_free_splitted_string(char** splittedString, int cnt);
+EXTERN_DLL_EXPORT int common_str_next_token(const char** rest, const char* delim, strSpan* token);
+EXTERN_DLL_EXPORT int common_str_count_tokens(const char* str, const char* delim);
 EXTERN_DLL_EXPORT int common_does_condition_exists(int conditions[], int condition, int conditionCnt);
 EXTERN_DLL_EXPORT int common_node_exists(Node** nodeArr, Node* node, int listCnt);
 EXTERN_DLL_EXPORT void common_initialize_node_list(int nodeListCnt);
+EXTERN_DLL_EXPORT void common_project_arena_reserve(size_t size);
+EXTERN_DLL_EXPORT void* common_project_arena_alloc(size_t size);
+EXTERN_DLL_EXPORT char* common_project_arena_strdup(const char* str);
+EXTERN_DLL_EXPORT void common_get_project_arena_stats(projectArenaStats* stats);
+EXTERN_DLL_EXPORT void common_release_project_arena();
 EXTERN_DLL_EXPORT void common_add_node_to_list(Node* node);
 EXTERN_DLL_EXPORT void common_generate_guid(char guid[GUID_LENGTH], int number_of_blocks);
 EXTERN_DLL_EXPORT int common_string_ends_with(const char *str, const char *suffix);
@@ -242,5 +637,6 @@ EXTERN_DLL_EXPORT size_t common_getline(char **lineptr, size_t *n, FILE *stream)
 EXTERN_DLL_EXPORT int common_zip_extract(const char* zip_name, const char* dir, void* arg);
 EXTERN_DLL_EXPORT int common_directory_exists(const char *path);
 EXTERN_DLL_EXPORT void ConnectMqtt(EngineConfiguration engine_configuration);
+EXTERN_DLL_EXPORT int common_get_mqtt_publish_failures_cnt();
 EXTERN_DLL_EXPORT void common_json_dump_table(Tables *tables);
 EXTERN_DLL_EXPORT void TestDump();
\ No newline at end of file
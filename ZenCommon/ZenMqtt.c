@@ -48,6 +48,9 @@ MQTTAsync_SSLOptions sslopts = MQTTAsync_SSLOptions_initializer;
 
 char _topic_prefix[255] = "";
 
+// Messages that failed to publish, exported by engine metrics
+int _publish_failures_cnt = 0;
+
 //**************************************************************************/
 //************************ START MQTT CALLBACKS ****************************/
 //**************************************************************************/
@@ -106,6 +109,7 @@ int mqtt_on_message_arrived(void* context, char* topicName, int topicLen, MQTTAs
 		/debug/stop				->	stop debugging session
 		/breakpoint/stop		->	step over
 		/breakpoint/continue	->	next step
+		/trace/dump				->	dump execution trace
 	*/
 
 	char payload[PAYLOAD_LENGTH];
@@ -130,6 +134,9 @@ int mqtt_on_message_arrived(void* context, char* topicName, int topicLen, MQTTAs
 	else if (common_string_ends_with(topicName, "/breakpoint/stop") || common_string_ends_with(topicName, "/debug/stop"))
 		stop_debugging_session();
 
+	else if (common_string_ends_with(topicName, "/trace/dump"))
+		dump_trace(payload, callbackTopic);
+
 	if (strcmp(callbackTopic, "") != 0)
 		mqtt_send_zen_message(payload, callbackTopic, client);
 
@@ -151,6 +158,7 @@ void mqtt_on_connect_failure(void* context, MQTTAsync_failureData* response)
 void mqtt_on_publish_failure(void* context, MQTTAsync_failureData* response)
 {
 	ClientCtx* client = (ClientCtx*)context;
+	ATOMIC_ADD(&_publish_failures_cnt, 1);
 	printf("MQTT Error : on_publish_failure\n");
 }
 //**************************************************************************/
@@ -224,6 +232,31 @@ void continue_with_breakpoint(char payload[PAYLOAD_LENGTH], char topicName[TOPIC
 	sprintf(topicName, "%s%s", "/breakpoint/stepover", _topic_prefix);
 }
 
+/**
+* Dumps execution trace to trace file. Response contains file and number of dumped records (-1 on error)
+*
+* @param	payload		response payload
+* @param	topicName	response topic
+*
+* @return	none
+*/
+void dump_trace(char payload[PAYLOAD_LENGTH], char topicName[TOPIC_LENGTH])
+{
+	cJSON *root;
+	char* tmp;
+	int recordsCnt = common_trace_dump(NULL);
+
+	root = cJSON_CreateObject();
+	cJSON_AddItemToObject(root, "File", cJSON_CreateString(common_trace_get_file()));
+	cJSON_AddItemToObject(root, "Records", cJSON_CreateNumber(recordsCnt));
+
+	tmp = cJSON_Print(root);
+	strncpy(payload, tmp, strlen(tmp) + 1);
+	free(tmp);
+	sprintf(topicName, "%s%s", _topic_prefix, "/trace/dumpResponse");
+	cJSON_Delete(root);
+}
+
 void get_fileListResponse_json(char payload[PAYLOAD_LENGTH], char topicName[TOPIC_LENGTH], ClientCtx* client)
 {
 	cJSON *root, *filesJson;
@@ -325,6 +358,7 @@ int mqtt_send_zen_message(char payload[PAYLOAD_LENGTH], char callbackTopic[TOPIC
 {
 	MQTTAsync_message pubmsg = MQTTAsync_message_initializer;
 	MQTTAsync_responseOptions opts = MQTTAsync_responseOptions_initializer;
+	int rc;
 
 	pubmsg.qos = 2;
 	pubmsg.retained = 0;
@@ -334,7 +368,21 @@ int mqtt_send_zen_message(char payload[PAYLOAD_LENGTH], char callbackTopic[TOPIC
 
 	pubmsg.payload = payload;
 	pubmsg.payloadlen = (int)strlen(payload);
-	return MQTTAsync_sendMessage(client->client, callbackTopic, &pubmsg, &opts);
+	rc = MQTTAsync_sendMessage(client->client, callbackTopic, &pubmsg, &opts);
+	// Message that wasn't even queued never reaches mqtt_on_publish_failure
+	if (rc != MQTTASYNC_SUCCESS)
+		ATOMIC_ADD(&_publish_failures_cnt, 1);
+	return rc;
+}
+
+/**
+* Returns number of messages that failed to publish
+*
+* @return	failures count
+*/
+EXTERN_DLL_EXPORT int common_get_mqtt_publish_failures_cnt()
+{
+	return ATOMIC_LOAD(&_publish_failures_cnt);
 }
 
 /**
@@ -404,6 +452,9 @@ void subscribe_system_topics(ClientCtx* context)
 
 	if (context->engineConfiguration.isRemoteInfoEnabled)
 		subscribe_topic("/info/gatewayRequest", context);
+
+	if (context->engineConfiguration.isTraceEnabled)
+		subscribe_topic("/trace/dump", context);
 }
 
 /**
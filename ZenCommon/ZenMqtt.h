@@ -45,5 +45,6 @@ void make_update(MQTTAsync_message* message, ClientCtx* client);
 void get_fileListResponse_json(char payload[PAYLOAD_LENGTH], char topicName[TOPIC_LENGTH], ClientCtx* client);
 void get_infoGet_json(char payload[PAYLOAD_LENGTH], char topicName[TOPIC_LENGTH], ClientCtx* client);
 void make_restart(ClientCtx* client);
+void dump_trace(char payload[PAYLOAD_LENGTH], char topicName[TOPIC_LENGTH]);
 int mqtt_send_zen_message(char payload[PAYLOAD_LENGTH], char callbackTopic[TOPIC_LENGTH], ClientCtx* client);
 void subscribe_system_topics(ClientCtx* context);
@@ -0,0 +1,381 @@
+/*************************************************************************
+ * Copyright (c) 2015, 2018 Zenodys BV
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contributors:
+ *    Tomaž Vinko
+ *
+ **************************************************************************/
+
+/*=======================================================================================
+|
+|       Node execution statistics
+|
+|		  * Each thread that executes node records into its own statistics block of that node,
+|			so recording doesn't take locks and doesn't share cache lines with other threads.
+|		  * Blocks of node are kept in lock-free list. Block is added once, when thread
+|			executes node for the first time.
+|		  * Readers merge all blocks of node : counters are summed, histograms are summed
+|			and percentiles are computed from merged histogram.
+|
++----------------------------------------------------------------------------------------
+|
+|   Known Bugs:		* Readers on 32 bit platforms can see torn 64 bit counters
+|
+*=======================================================================================*/
+
+#include "ZenCommon.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <intrin.h>
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+// Statistics of node, written only by owner thread
+typedef struct nodeStatsBlock
+{
+	// Owner thread
+	const void* owner;
+	struct nodeStatsBlock* next;
+	volatile uint64_t errorCnt;
+	volatile uint64_t queueWaitCnt;
+	volatile uint64_t queueWaitTotalNs;
+	volatile uint64_t queueWaitMaxNs;
+	// Execution times, histogram count is fire count
+	latencyHistogram execution;
+} nodeStatsBlock;
+
+// Address of this variable identifies thread as owner of statistics blocks
+THREAD_LOCAL int _stats_thread_token;
+
+// Set when warm up of benchmark ends (see common_stats_begin_measurement)
+volatile int _stats_is_measuring = 0;
+
+#if defined(_WIN32)
+LARGE_INTEGER _stats_counter_frequency;
+#endif
+
+/**
+* Returns index of most significant set bit
+*
+* @param value	non zero value
+* @return		bit index
+*/
+int stats_msb(uint64_t value)
+{
+#if defined(_WIN32)
+	unsigned long index;
+	_BitScanReverse64(&index, value);
+	return (int)index;
+#else
+	return 63 - __builtin_clzll(value);
+#endif
+}
+
+/**
+* Returns histogram bucket of value. Values smaller than NODE_STATS_SUB_BUCKETS have their own buckets,
+* bigger ones are put into one of NODE_STATS_SUB_BUCKETS linear buckets of their power of two range
+*
+* @param value	value in ns
+* @return		bucket index
+*/
+int stats_bucket(uint64_t value)
+{
+	int msb, group;
+
+	if (value < NODE_STATS_SUB_BUCKETS)
+		return (int)value;
+
+	msb = stats_msb(value);
+	group = msb - NODE_STATS_SUB_BUCKET_BITS + 1;
+	if (group >= NODE_STATS_GROUPS)
+		return NODE_STATS_BUCKETS - 1;
+
+	return group * NODE_STATS_SUB_BUCKETS + (int)((value >> (msb - NODE_STATS_SUB_BUCKET_BITS)) & (NODE_STATS_SUB_BUCKETS - 1));
+}
+
+/**
+* Returns highest value that is counted in bucket
+*
+* @param bucket		bucket index
+* @return			value in ns
+*/
+uint64_t stats_bucket_upper_value(int bucket)
+{
+	int group = bucket / NODE_STATS_SUB_BUCKETS;
+	uint64_t sub = bucket % NODE_STATS_SUB_BUCKETS;
+
+	if (group == 0)
+		return sub;
+
+	return ((NODE_STATS_SUB_BUCKETS + sub + 1) << (group - 1)) - 1;
+}
+
+/**
+* Returns value at percentile of histogram. Highest value of bucket is returned, but never more than max recorded value
+*
+* @param buckets	merged histogram
+* @param totalCnt	number of values in histogram
+* @param maxValue	max recorded value
+* @param percentile	percentile (eg. 99.9)
+* @return			value in ns
+*/
+uint64_t stats_percentile(const uint64_t* buckets, uint64_t totalCnt, uint64_t maxValue, double percentile)
+{
+	int i;
+	uint64_t cnt = 0;
+	uint64_t rank;
+	uint64_t value;
+
+	if (totalCnt == 0)
+		return 0;
+
+	rank = (uint64_t)(percentile / 100.0 * (double)totalCnt + 0.5);
+	if (rank < 1)
+		rank = 1;
+
+	for (i = 0; i < NODE_STATS_BUCKETS; i++)
+	{
+		cnt += buckets[i];
+		if (cnt >= rank)
+		{
+			value = stats_bucket_upper_value(i);
+			return value < maxValue ? value : maxValue;
+		}
+	}
+	return maxValue;
+}
+
+/**
+* Returns statistics block of current thread for node. Block is created when thread executes node for the first time.
+* Only few threads execute the same node, so list is short
+*
+* @param node	node
+* @return		statistics block
+*/
+nodeStatsBlock* get_stats_block(Node* node)
+{
+	nodeStatsBlock* head = ATOMIC_LOAD_PTR(&node->statsBlocks);
+	nodeStatsBlock* block;
+
+	for (block = head; block != NULL; block = block->next)
+	{
+		if (block->owner == &_stats_thread_token)
+			return block;
+	}
+
+	block = calloc(1, sizeof(nodeStatsBlock));
+	block->owner = &_stats_thread_token;
+	do
+	{
+		head = ATOMIC_LOAD_PTR(&node->statsBlocks);
+		block->next = head;
+	} while (!ATOMIC_CAS_PTR(&node->statsBlocks, head, block));
+
+	return block;
+}
+
+/**
+* Frees statistics blocks of node. Nobody may execute node meanwhile
+*
+* @param node	node
+* @return		void
+*/
+void release_stats_blocks(Node* node)
+{
+	nodeStatsBlock* block;
+	while (node->statsBlocks != NULL)
+	{
+		block = node->statsBlocks;
+		node->statsBlocks = block->next;
+		free(block);
+	}
+}
+
+/**
+* Returns monotonic time. Used for measuring durations, not for wall clock time
+*
+* @return	time in ns
+*/
+EXTERN_DLL_EXPORT uint64_t common_get_time_ns()
+{
+#if defined(_WIN32)
+	LARGE_INTEGER counter;
+	if (_stats_counter_frequency.QuadPart == 0)
+		QueryPerformanceFrequency(&_stats_counter_frequency);
+	QueryPerformanceCounter(&counter);
+	return (uint64_t)((double)counter.QuadPart * 1000000000.0 / (double)_stats_counter_frequency.QuadPart);
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/**
+* Records node execution into statistics block of current thread
+*
+* @param node			executed node
+* @param executionNs	execution time
+* @param isError		1 if execution ended with error
+* @return				void
+*/
+EXTERN_DLL_EXPORT void common_stats_record_execution(Node* node, uint64_t executionNs, int isError)
+{
+	nodeStatsBlock* block = get_stats_block(node);
+
+	if (isError)
+		block->errorCnt++;
+	common_histogram_record(&block->execution, executionNs);
+}
+
+/**
+* Records time that node waited between becoming ready and start of execution
+*
+* @param node			executed node
+* @param queueWaitNs	wait time
+* @return				void
+*/
+EXTERN_DLL_EXPORT void common_stats_record_queue_wait(Node* node, uint64_t queueWaitNs)
+{
+	nodeStatsBlock* block = get_stats_block(node);
+
+	block->queueWaitCnt++;
+	block->queueWaitTotalNs += queueWaitNs;
+	if (queueWaitNs > block->queueWaitMaxNs)
+		block->queueWaitMaxNs = queueWaitNs;
+}
+
+/**
+* Clears maximum queue wait of node, so that maximum covers only time after the call (e.g. after warm up).
+* Owner thread can concurrently store wait that it compared with old maximum, which is still a valid sample
+*
+* @param node	node
+* @return		void
+*/
+EXTERN_DLL_EXPORT void common_stats_reset_queue_wait_max(Node* node)
+{
+	nodeStatsBlock* block;
+
+	for (block = ATOMIC_LOAD_PTR(&node->statsBlocks); block != NULL; block = block->next)
+		block->queueWaitMaxNs = 0;
+}
+
+/**
+* Marks end of benchmark warm up. Elements that keep their own counters (e.g. ZenEventGenerator)
+* check it with common_stats_is_measuring and restart counting when it becomes set
+*
+* @return	void
+*/
+EXTERN_DLL_EXPORT void common_stats_begin_measurement()
+{
+	ATOMIC_STORE(&_stats_is_measuring, 1);
+}
+
+/**
+* Returns whether benchmark warm up has ended
+*
+* @return	1 after common_stats_begin_measurement was called, 0 otherwise
+*/
+EXTERN_DLL_EXPORT int common_stats_is_measuring()
+{
+	return ATOMIC_LOAD(&_stats_is_measuring);
+}
+
+/**
+* Returns node statistics, merged from all threads that executed node. Doesn't take any locks,
+* so it can be called while node is running. Counters of running node can be one execution behind
+*
+* @param node		node
+* @param stats		merged statistics (output argument)
+* @return			void
+*/
+EXTERN_DLL_EXPORT void common_get_node_stats(Node* node, nodeStats* stats)
+{
+	uint64_t buckets[NODE_STATS_BUCKETS];
+	uint64_t histogramCnt = 0;
+	nodeStatsBlock* block;
+	int i;
+
+	memset(stats, 0, sizeof(nodeStats));
+	memset(buckets, 0, sizeof(buckets));
+
+	for (block = ATOMIC_LOAD_PTR(&node->statsBlocks); block != NULL; block = block->next)
+	{
+		stats->fireCnt += block->execution.cnt;
+		stats->errorCnt += block->errorCnt;
+		stats->executionTotalNs += block->execution.totalNs;
+		if (block->execution.maxNs > stats->executionMaxNs)
+			stats->executionMaxNs = block->execution.maxNs;
+		stats->queueWaitCnt += block->queueWaitCnt;
+		stats->queueWaitTotalNs += block->queueWaitTotalNs;
+		if (block->queueWaitMaxNs > stats->queueWaitMaxNs)
+			stats->queueWaitMaxNs = block->queueWaitMaxNs;
+
+		for (i = 0; i < NODE_STATS_BUCKETS; i++)
+		{
+			buckets[i] += block->execution.buckets[i];
+			histogramCnt += block->execution.buckets[i];
+		}
+	}
+
+	// Percentiles use merged histogram count, which can be ahead of fireCnt while node is running
+	stats->executionP50Ns = stats_percentile(buckets, histogramCnt, stats->executionMaxNs, 50.0);
+	stats->executionP99Ns = stats_percentile(buckets, histogramCnt, stats->executionMaxNs, 99.0);
+	stats->executionP999Ns = stats_percentile(buckets, histogramCnt, stats->executionMaxNs, 99.9);
+}
+
+/**
+* Records value into histogram. Histogram must have single writer
+*
+* @param histogram	histogram
+* @param valueNs	value in ns
+* @return			void
+*/
+EXTERN_DLL_EXPORT void common_histogram_record(latencyHistogram* histogram, uint64_t valueNs)
+{
+	histogram->cnt++;
+	histogram->totalNs += valueNs;
+	if (valueNs > histogram->maxNs)
+		histogram->maxNs = valueNs;
+	histogram->buckets[stats_bucket(valueNs)]++;
+}
+
+/**
+* Returns value at percentile of histogram
+*
+* @param histogram	histogram
+* @param percentile	percentile (eg. 99.9)
+* @return			value in ns, 0 if histogram is empty
+*/
+EXTERN_DLL_EXPORT uint64_t common_histogram_percentile(const latencyHistogram* histogram, double percentile)
+{
+	uint64_t buckets[NODE_STATS_BUCKETS];
+	uint64_t histogramCnt = 0;
+	int i;
+
+	for (i = 0; i < NODE_STATS_BUCKETS; i++)
+	{
+		buckets[i] = histogram->buckets[i];
+		histogramCnt += buckets[i];
+	}
+	return stats_percentile(buckets, histogramCnt, histogram->maxNs, percentile);
+}
@@ -0,0 +1,419 @@
+/*************************************************************************
+ * Copyright (c) 2015, 2018 Zenodys BV
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contributors:
+ *    Tomaž Vinko
+ *
+ **************************************************************************/
+
+/*=======================================================================================
+|
+|       Execution trace recorder
+|
+|		  * Enabled with [Trace] Enabled = 1. Each thread records into its own ring of
+|			[Trace] RecordsPerThread records, oldest ones are overwritten. Recording doesn't
+|			take locks and costs two monotonic clock reads and one record write.
+|		  * Recorded : node executions, loop and node lock acquisitions, waits on and signals
+|			of pause conditions, event pushes and pulls.
+|		  * Records are timestamped with rdtsc on x86/x64 (CLOCK_MONOTONIC elsewhere). Ticks are
+|			converted to ns on dump, with rate measured from trace start to dump.
+|		  * Rings are dumped to [Trace] File in Chrome trace_event JSON (chrome://tracing,
+|			Perfetto) on SIGUSR1 or on MQTT /trace/dump message.
+|		  * Dump runs while threads keep recording. Records overwritten during dump are skipped.
+|
++----------------------------------------------------------------------------------------
+|
+|   Known Bugs:		* rdtsc timestamps assume invariant TSC, synchronized between cores
+|
+*=======================================================================================*/
+
+#include "ZenCommon.h"
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <intrin.h>
+#define THREAD_LOCAL __declspec(thread)
+#else
+#include <unistd.h>
+#define THREAD_LOCAL __thread
+#endif
+
+#if defined(_WIN32) || defined(__x86_64__) || defined(__i386__)
+#if !defined(_WIN32)
+#include <x86intrin.h>
+#endif
+#define TRACE_TICKS() __rdtsc()
+#else
+#define TRACE_TICKS() common_get_time_ns()
+#endif
+
+// Dump requests (signal) are checked with this period
+#define TRACE_DUMP_POLL_MS 100
+
+typedef struct
+{
+	uint64_t beginTicks;
+	// Zero for instants
+	uint64_t durationTicks;
+	Node* node;
+	trace_type type;
+} traceRecord;
+
+// Trace ring of one thread, written only by owner thread
+typedef struct traceRing
+{
+	struct traceRing* next;
+	int threadIndex;
+	// Number of records ever written. Record is written before index is increased
+	volatile unsigned int writeIndex;
+	traceRecord* records;
+} traceRing;
+
+// Names and categories of record types, indexed by trace_type
+const char* _trace_names[] = { NULL, "loop lock", "node lock", "pause wait", "pause signal", "event push", "event pull" };
+const char* _trace_categories[] = { "node", "lock", "lock", "pause", "pause", "event", "event" };
+
+THREAD_LOCAL traceRing* _trace_thread_ring;
+traceRing* _trace_rings = NULL;
+int _trace_threads_cnt = 0;
+
+volatile int _trace_enabled = 0;
+unsigned int _trace_capacity = 0;
+// Trace start, used for converting ticks to ns
+uint64_t _trace_start_ticks;
+uint64_t _trace_start_ns;
+char _trace_file[MAX_PATH] = TRACE_DEFAULT_FILE;
+
+// Set from signal handler, served by dump thread
+volatile int _trace_dump_requested = 0;
+pthread_t _trace_dump_thread;
+pthread_mutex_t _trace_dump_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+* Returns ring of current thread. Ring is created when thread records for the first time
+*
+* @return	trace ring
+*/
+traceRing* get_trace_ring()
+{
+	traceRing* ring = _trace_thread_ring;
+	traceRing* head;
+
+	if (ring != NULL)
+		return ring;
+
+	ring = calloc(1, sizeof(traceRing));
+	ring->records = calloc(_trace_capacity, sizeof(traceRecord));
+	ring->threadIndex = ATOMIC_ADD(&_trace_threads_cnt, 1);
+	do
+	{
+		head = ATOMIC_LOAD_PTR(&_trace_rings);
+		ring->next = head;
+	} while (!ATOMIC_CAS_PTR(&_trace_rings, head, ring));
+
+	_trace_thread_ring = ring;
+	return ring;
+}
+
+/**
+* Writes record into ring of current thread
+*
+* @param type				record type
+* @param node				node that record belongs to
+* @param beginTicks			begin time
+* @param durationTicks		duration, zero for instants
+* @return					void
+*/
+void trace_record(trace_type type, Node* node, uint64_t beginTicks, uint64_t durationTicks)
+{
+	traceRing* ring = get_trace_ring();
+	unsigned int index = ring->writeIndex;
+	traceRecord* record = &ring->records[index & (_trace_capacity - 1)];
+
+	record->beginTicks = beginTicks;
+	record->durationTicks = durationTicks;
+	record->node = node;
+	record->type = type;
+	// Publish record to dump
+	ATOMIC_STORE_RELEASE(&ring->writeIndex, index + 1);
+}
+
+/**
+* Writes JSON string, escaped
+*
+* @param file	output file
+* @param str	string
+* @return		void
+*/
+void trace_write_json_string(FILE* file, const char* str)
+{
+	fputc('"', file);
+	for (; *str != '\0'; str++)
+	{
+		if (*str == '"' || *str == '\\')
+			fprintf(file, "\\%c", *str);
+		else if ((unsigned char)*str < 0x20)
+			fprintf(file, "\\u%04x", *str);
+		else
+			fputc(*str, file);
+	}
+	fputc('"', file);
+}
+
+/**
+* Writes one record as trace event. Node executions are named by node, other records have node in arguments
+*
+* @param file			output file
+* @param record			record
+* @param threadIndex	thread that wrote record
+* @param ticksPerNs		ticks rate
+* @return				void
+*/
+void trace_write_record(FILE* file, const traceRecord* record, int threadIndex, double ticksPerNs)
+{
+	fprintf(file, ",\n{\"name\":");
+	trace_write_json_string(file, record->type == TRACE_NODE_EXECUTION ? record->node->id : _trace_names[record->type]);
+	fprintf(file, ",\"cat\":\"%s\",\"pid\":1,\"tid\":%d,\"ts\":%.3f", _trace_categories[record->type], threadIndex,
+		(double)(int64_t)(record->beginTicks - _trace_start_ticks) / ticksPerNs / 1000.0);
+
+	if (record->type >= TRACE_PAUSE_SIGNAL)
+		fprintf(file, ",\"ph\":\"i\",\"s\":\"t\"");
+	else
+		fprintf(file, ",\"ph\":\"X\",\"dur\":%.3f", (double)record->durationTicks / ticksPerNs / 1000.0);
+
+	if (record->type != TRACE_NODE_EXECUTION)
+	{
+		fprintf(file, ",\"args\":{\"node\":");
+		trace_write_json_string(file, record->node->id);
+		fprintf(file, "}");
+	}
+	fprintf(file, "}");
+}
+
+/**
+* Sleeps dump thread
+*
+* @param ms		sleep time in milliseconds
+* @return		void
+*/
+void trace_sleep(int ms)
+{
+#if defined(_WIN32)
+	Sleep(ms);
+#else
+	usleep(ms * 1000);
+#endif
+}
+
+/**
+* Dump thread. Dumps trace when dump is requested by signal. File can't be written from signal handler
+*
+* @param params		not used
+* @return			NULL
+*/
+void* trace_dump_loop(void* params)
+{
+	while (1)
+	{
+		trace_sleep(TRACE_DUMP_POLL_MS);
+		if (_trace_dump_requested)
+		{
+			_trace_dump_requested = 0;
+			common_trace_dump(NULL);
+		}
+	}
+	return NULL;
+}
+
+#if !defined(_WIN32)
+/**
+* SIGUSR1 handler. Only requests dump
+*
+* @param signal		signal number
+* @return			void
+*/
+void trace_on_signal(int signal)
+{
+	_trace_dump_requested = 1;
+}
+#endif
+
+/**
+* Inits tracer. Must be called before threads that are traced are started
+*
+* @param isEnabled			1 to record traces
+* @param recordsPerThread	ring size of each thread. It's rounded up to power of two, default is used if zero or less
+* @param file				dump file, default is used if NULL or empty
+* @return					void
+*/
+EXTERN_DLL_EXPORT void common_trace_init(int isEnabled, int recordsPerThread, const char* file)
+{
+	if (!isEnabled)
+		return;
+
+	if (recordsPerThread <= 0)
+		recordsPerThread = TRACE_DEFAULT_RECORDS_PER_THREAD;
+	for (_trace_capacity = 1; _trace_capacity < (unsigned int)recordsPerThread; _trace_capacity <<= 1)
+		;
+
+	if (file != NULL && file[0] != '\0')
+		snprintf(_trace_file, sizeof(_trace_file), "%s", file);
+
+	_trace_start_ticks = TRACE_TICKS();
+	_trace_start_ns = common_get_time_ns();
+	pthread_create(&_trace_dump_thread, NULL, trace_dump_loop, NULL);
+#if !defined(_WIN32)
+	signal(SIGUSR1, trace_on_signal);
+#endif
+	_trace_enabled = 1;
+	printf("Trace enabled, %u records per thread. Dump is written to %s\n", _trace_capacity, _trace_file);
+}
+
+/**
+* Returns begin time of traced duration, that is later passed to common_trace_end
+*
+* @return	begin time in ticks, zero if tracing is disabled
+*/
+EXTERN_DLL_EXPORT uint64_t common_trace_begin()
+{
+	return _trace_enabled ? TRACE_TICKS() : 0;
+}
+
+/**
+* Records duration from begin time until now
+*
+* @param type		record type
+* @param node		node that duration belongs to
+* @param beginTicks	begin time (see common_trace_begin)
+* @return				void
+*/
+EXTERN_DLL_EXPORT void common_trace_end(trace_type type, Node* node, uint64_t beginTicks)
+{
+	uint64_t endTicks;
+
+	if (beginTicks == 0)
+		return;
+
+	endTicks = TRACE_TICKS();
+	trace_record(type, node, beginTicks, endTicks > beginTicks ? endTicks - beginTicks : 0);
+}
+
+/**
+* Records instant
+*
+* @param type		record type
+* @param node		node that instant belongs to
+* @return			void
+*/
+EXTERN_DLL_EXPORT void common_trace_instant(trace_type type, Node* node)
+{
+	if (!_trace_enabled)
+		return;
+
+	trace_record(type, node, TRACE_TICKS(), 0);
+}
+
+/**
+* Requests dump from dump thread. Safe to call from signal handler
+*
+* @return	void
+*/
+EXTERN_DLL_EXPORT void common_trace_request_dump()
+{
+	_trace_dump_requested = 1;
+}
+
+/**
+* Returns dump file
+*
+* @return	dump file path
+*/
+EXTERN_DLL_EXPORT const char* common_trace_get_file()
+{
+	return _trace_file;
+}
+
+/**
+* Dumps records of all threads to file in Chrome trace_event JSON format. Threads keep recording while dump runs.
+* Ring is copied first, records that were overwritten while copying are skipped
+*
+* @param file	dump file. If NULL, [Trace] File is used
+* @return		number of dumped records, -1 on error
+*/
+EXTERN_DLL_EXPORT int common_trace_dump(const char* file)
+{
+	FILE* output;
+	traceRing* ring;
+	traceRecord* records;
+	unsigned int startIndex, endIndex, index;
+	int recordsCnt = 0;
+	uint64_t elapsedNs;
+	double ticksPerNs;
+
+	if (!_trace_enabled)
+		return -1;
+
+	if (file == NULL)
+		file = _trace_file;
+
+	pthread_mutex_lock(&_trace_dump_lock);
+	output = fopen(file, "w");
+	if (output == NULL)
+	{
+		pthread_mutex_unlock(&_trace_dump_lock);
+		printf("Trace : can't open %s\n", file);
+		return -1;
+	}
+
+	elapsedNs = common_get_time_ns() - _trace_start_ns;
+	ticksPerNs = elapsedNs > 0 ? (double)(TRACE_TICKS() - _trace_start_ticks) / (double)elapsedNs : 1.0;
+	if (ticksPerNs <= 0)
+		ticksPerNs = 1.0;
+
+	records = malloc(_trace_capacity * sizeof(traceRecord));
+	fprintf(output, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"ZenEngine\"}}");
+
+	for (ring = ATOMIC_LOAD_PTR(&_trace_rings); ring != NULL; ring = ring->next)
+	{
+		endIndex = (unsigned int)ATOMIC_LOAD(&ring->writeIndex);
+		startIndex = endIndex > _trace_capacity ? endIndex - _trace_capacity : 0;
+		for (index = startIndex; index != endIndex; index++)
+			records[index & (_trace_capacity - 1)] = ring->records[index & (_trace_capacity - 1)];
+
+		// Owner could overwrite oldest records while they were copied
+		ATOMIC_FENCE();
+		while (startIndex != endIndex && (unsigned int)ATOMIC_LOAD(&ring->writeIndex) - startIndex >= _trace_capacity)
+			startIndex++;
+
+		fprintf(output, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}", ring->threadIndex, ring->threadIndex);
+		for (index = startIndex; index != endIndex; index++)
+		{
+			trace_write_record(output, &records[index & (_trace_capacity - 1)], ring->threadIndex, ticksPerNs);
+			recordsCnt++;
+		}
+	}
+
+	fprintf(output, "\n]}\n");
+	fclose(output);
+	free(records);
+	pthread_mutex_unlock(&_trace_dump_lock);
+
+	printf("Trace : %d records dumped to %s\n", recordsCnt, file);
+	return recordsCnt;
+}
@@ -27,19 +27,12 @@
 |
 |   Known Bugs:		* none
 |
-|	     To Do:		* Do not allocate memory instead of allocating max, for event 
-|					  buffers length of zero
-|					* Create on node complete callback:
-|						ptrOnNodeComplete onNodeCompleteFunct = 
-|							(ptrOnNodeComplete)GetFunction(
-|								((Node**)(node->nodesToTrigger))[i]->implementation, 
-|								"onNodeComplete"
-|							);
-|						
-|					  if (onNodeCompleteFunct)
-|							onNodeCompleteFunct(((Node**)(node->nodesToTrigger))[i]);
+|	     To Do:		* none
 *==========================================================================================*/
 #include "ZenEngine.h"
+#include "ZenScheduler.h"
+#include "ZenProjectImage.h"
+#include "ZenMetrics.h"
 #include <errno.h>
 #include <time.h>
 #include "pthread.h"
@@ -50,6 +43,12 @@
 #include "cJSON.h"
 #include <string.h>
 #include "ini.h"
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <unistd.h>
+#endif
 
 const char* ENGINE_VERSION = "1.0.0";
 
@@ -60,23 +59,19 @@ const char* PROP_OPERATOR = "OPERATOR";
 const char* ELEMENT_TYPE_ACTION = "ACTION";
 const char* ELEMENT_TYPE_EVENT = "EVENT";
 
-const char* STATUS_RUNNING = "RUNNING";
-const char* STATUS_ARRIVED = "ARRIVED";
-const char* STATUS_STOPPED = "STOPPED";
-
 const int MAX_EVENT_QUEUE_LENGTH = 100000;
 
 struct Implementation **_implementationList;
+
+// Used by nodes without loaded implementation
+ImplementationVTable _empty_vtable;
 char _projectId[PROJECT_ID_LENGTH];
 
 
-// Loop, node and start node locks
-pthread_mutex_t _loop_locks[1000];
+// Loop locks, one per loop. Node locks are embedded in nodes (see nodeSyncObjects)
+pthread_mutex_t* _loop_locks;
 int _loop_locks_cnt = 0;
 
-pthread_mutex_t _node_locks[1000];
-int _node_locks_cnt = 0;
-
 pthread_mutex_t node_start_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 //Sync helpers
@@ -90,8 +85,26 @@ char _implementations_file[MAX_PATH];
 char _settings_file[MAX_PATH];
 char _relations_file[MAX_PATH];
 char _nodes_file[MAX_PATH];
+char _image_file[MAX_PATH];
 char _implementations_path[MAX_PATH];
 
+// Compiled project, mapped from image file
+projectImage _projectImage;
+
+// Nodes, allocated as one contiguous array. Cold node data is kept in separate array
+Node* _nodes;
+nodeColdData* _nodes_cold_data;
+
+// Hot scheduling state in structure of arrays form, indexed by node index
+nodeSchedulingState _scheduling;
+
+// Node relations in CSR form : row offsets (nodes count + 1) and node indices.
+// Child rows are used directly from project image, parent rows are built from them
+uint32_t* _true_parent_rows;
+uint32_t* _true_parents;
+uint32_t* _false_parent_rows;
+uint32_t* _false_parents;
+
 int _implementationCount;
 
 struct nodeContextParamsStruct {
@@ -99,9 +112,9 @@ struct nodeContextParamsStruct {
 	Node* node;
 };
 
-struct nodeContextParamsStruct node_context[MAX_NODES_COUNT];
-pthread_t node_threads[MAX_NODES_COUNT];
-int nodeContextParamsCnt = 0;
+// Node thread contexts and threads (thread per node mode), indexed by node index
+struct nodeContextParamsStruct* _node_contexts;
+pthread_t* _node_threads;
 
 pthread_mutex_t pause_node_mutex = PTHREAD_MUTEX_INITIALIZER;
 
@@ -111,13 +124,26 @@ pthread_mutex_t pause_node_mutex = PTHREAD_MUTEX_INITIALIZER;
 int main(int argc, char **argv)
 {
 	char input[10];
+	int benchSeconds = 0;
+	size_t residentSizeBeforeLoad;
 	
 	strncpy(engineConfiguration.engineVersion, ENGINE_VERSION, strlen(ENGINE_VERSION) + 1);
 	printf("ZenoEngine v%s started.....\n",ENGINE_VERSION);
 	
 	SetPaths();
+
+	// Only compile project image (eg. after project update), so that next start doesn't need to
+	if (argc > 1 && strcmp(argv[1], "--compile") == 0)
+		return LoadProjectImage(1);
+
+	// Run project for given time, print benchmark result and exit (used by ZenBench)
+	if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+		benchSeconds = argc > 2 ? atoi(argv[2]) : BENCH_DEFAULT_SECONDS;
+
 	ReadEngineConfiguration();
+	common_trace_init(engineConfiguration.isTraceEnabled, engineConfiguration.traceRecordsPerThread, engineConfiguration.traceFile);
 	common_init_project(_project_root, _projectId, engineConfiguration, execNode);
+	common_set_signal_node_callback(SignalNode);
 
 	strncpy(engineConfiguration.workingDir, _working_directory, strlen(_working_directory) + 1);
 	strncpy(engineConfiguration.projectRoot, _project_root, strlen(_project_root) + 1);
@@ -125,12 +151,24 @@ int main(int argc, char **argv)
 	DeleteObsoleteNodeFiles();
 	printf("Instance : %s\n\n\n", engineConfiguration.workstationName);
 	ConnectMqtt(engineConfiguration);
+	residentSizeBeforeLoad = GetResidentMemorySize();
+	if (LoadProjectImage(0) != 0)
+	{
+		getchar();
+		exit(1);
+	}
 	FillImplementationList();
 	FillNodeList();
 	ExecuteMainThreadActions();
 	FillRelationList();
+	PrintProjectArenaStats();
 	SyncLoops();
 	StartLoops();
+	if (engineConfiguration.metricsPort > 0)
+		MetricsStart(engineConfiguration.metricsAddress != NULL && engineConfiguration.metricsAddress[0] != '\0' ? engineConfiguration.metricsAddress : METRICS_DEFAULT_ADDRESS, engineConfiguration.metricsPort);
+	if (benchSeconds > 0)
+		RunBench(benchSeconds, residentSizeBeforeLoad);
+
 	fgets(input, BUFSIZ, stdin);
 
 	while (strcmp(input, "quit\n") != 0) {
@@ -164,30 +202,64 @@ int execNode(Node *node)
 
 /**
 * Safely starts node main loop. Node can be started as start node, or node that starts after parent node ends.
-* node_context collection must be thread safe.
+* Each node has its own context and thread slot, so node thread is created only once.
+*
+* In worker pool mode node is just put on run queue.
 *
 * @param node	node which StartNode function is going to be called in separate thread
 * @return	void
 */
 void SafeNodeStart(Node *node)
 {
+	ATOMIC_STORE64(&node->readyNs, common_get_time_ns());
+	if (engineConfiguration.executionMode == EXECUTION_MODE_WORKER_POOL)
+	{
+		SchedulerEnqueueNode(node);
+		return;
+	}
+
 	pthread_mutex_lock(&node_start_mutex);
-	node_context[nodeContextParamsCnt].async = 1;
-	node_context[nodeContextParamsCnt].node = node;
-	pthread_create(&node_threads[nodeContextParamsCnt], NULL, StartNode, &node_context[nodeContextParamsCnt]);
-	nodeContextParamsCnt++;
+	if (!node->isStarted)
+	{
+		node->isStarted = 1;
+		_node_contexts[node->index].async = 1;
+		_node_contexts[node->index].node = node;
+		pthread_create(&_node_threads[node->index], NULL, StartNode, &_node_contexts[node->index]);
+	}
 	pthread_mutex_unlock(&node_start_mutex);
 }
 
+/**
+* Wakes up paused node. In thread per node mode, node's thread is signalled.
+* In worker pool mode, node is put on run queue.
+*
+* @param node	node to wake up
+* @return	void
+*/
+void SignalNode(Node *node)
+{
+	ATOMIC_STORE64(&node->readyNs, common_get_time_ns());
+	common_trace_instant(TRACE_PAUSE_SIGNAL, node);
+	if (engineConfiguration.executionMode == EXECUTION_MODE_WORKER_POOL)
+		SchedulerEnqueueNode(node);
+	else
+		common_signal_pause_condition(node);
+}
+
 /**
 * Execute "Start" nodes, each one in new thread.
 * This is the first function in "starting nodes" series.
 * Nodes are started with async parameter setted to true. This means that for each node new thread with endless loop is created
+* In worker pool mode, workers are created first and "Start" nodes are put on run queue
 * @return	void
 */
 void StartLoops()
 {
 	int i;
+
+	if (engineConfiguration.executionMode == EXECUTION_MODE_WORKER_POOL)
+		SchedulerInit(engineConfiguration.workersCnt, _loop_locks_cnt);
+
 	for (i = 0; i < COMMON_NODE_LIST_LENGTH; i++)
 	{
 		if ((strcmp(COMMON_NODE_LIST[i]->implementationId, "ZenStart#0#") == 0) && strcmp(common_get_node_arg(COMMON_NODE_LIST[i], "ACTIVE"), "0") != 0)
@@ -209,6 +281,7 @@ void StartNode(void *context)
 	struct nodeContextParamsStruct *nodeParams = context;
 	nodeParams->node->isStarted = 1;
 	int isNodeFirstFire = 1;
+	uint64_t traceBegin;
 
 	if (nodeParams->async)
 	{
@@ -218,7 +291,9 @@ void StartNode(void *context)
 				common_wait_debug_signal();
 
 			// Lock main loop sync
+			traceBegin = common_trace_begin();
 			pthread_mutex_lock(&_loop_locks[nodeParams->node->loopLockId]);
+			common_trace_end(TRACE_LOOP_LOCK, nodeParams->node, traceBegin);
 
 			StartNodeCore(nodeParams->node, &isNodeFirstFire);
 
@@ -232,6 +307,30 @@ void StartNode(void *context)
 		StartNodeCore(nodeParams->node, &isNodeFirstFire);
 }
 
+/**
+* Executes node picked from run queue by worker (worker pool mode).
+* Same as one iteration of StartNode loop, but without pausing the thread.
+* Loop lock is held while node is executing, same as in thread per node mode.
+*
+* @param node	node to execute
+* @return		void
+*/
+void ExecuteScheduledNode(Node* node)
+{
+	int isNodeFirstFire = !node->isStarted;
+	uint64_t traceBegin;
+	node->isStarted = 1;
+
+	if (common_is_debug_mode_enabled())
+		common_wait_debug_signal();
+
+	traceBegin = common_trace_begin();
+	pthread_mutex_lock(&_loop_locks[node->loopLockId]);
+	common_trace_end(TRACE_LOOP_LOCK, node, traceBegin);
+	StartNodeCore(node, &isNodeFirstFire);
+	pthread_mutex_unlock(&_loop_locks[node->loopLockId]);
+}
+
 /**
 * Main start node logic. It can be called from engine's StartNode loop or from nodes
 *
@@ -249,7 +348,35 @@ void StartNodeCore(Node* node, int* isNodeFirstFire)
 	if (node->isActionable || !(*isNodeFirstFire))
 		OnNodeFinish(node);
 	else
+	{
 		*(isNodeFirstFire) = 0;
+		PublishNodeCondition(node);
+		SetNodeStatus(node, NODE_STATUS_ARRIVED);
+	}
+}
+
+/**
+* Sets node status and wakes up parents, that are waiting in StartOrSignalNodes for node to stop running.
+* Node lock is taken only if someone is waiting. Waiter registers itself in statusWaitersCnt before it reads status,
+* so either setter sees the waiter, or waiter sees new status.
+*
+* @param	node	node which status is changed
+* @param	status	new status
+* @return	void
+*/
+void SetNodeStatus(Node* node, node_status status)
+{
+	uint64_t traceBegin;
+
+	ATOMIC_STORE(&node->status, status);
+	if (ATOMIC_LOAD(&node->statusWaitersCnt) > 0)
+	{
+		traceBegin = common_trace_begin();
+		pthread_mutex_lock(&node->sync.nodeLock);
+		common_trace_end(TRACE_NODE_LOCK, node, traceBegin);
+		pthread_cond_broadcast(&node->sync.finishCondition);
+		pthread_mutex_unlock(&node->sync.nodeLock);
+	}
 }
 
 /**
@@ -257,30 +384,40 @@ void StartNodeCore(Node* node, int* isNodeFirstFire)
 *		+) onNodeInit
 *		+) executeAction
 *
+* Execution time and time that node waited since it became ready are recorded in node statistics.
+* Execution is also recorded in execution trace, when tracing is enabled.
+*
 * @param	context		node context (node struct & async flag)
 * @return	void
 */
 void RunNodeInterfaces(Node* node)
 {
+	uint64_t traceBegin = common_trace_begin();
+	uint64_t startNs = common_get_time_ns();
+	uint64_t readyNs = ATOMIC_EXCHANGE64(&node->readyNs, 0);
+	if (readyNs != 0)
+		common_stats_record_queue_wait(node, startNs > readyNs ? startNs - readyNs : 0);
+
 	node->started = 1;
 	node->isEventActive = 1;
-	strncpy(node->status, STATUS_RUNNING, strlen(STATUS_RUNNING) + 1);
+	ATOMIC_STORE(&node->status, NODE_STATUS_RUNNING);
 	strncpy(node->errorMessage, "", 1);
 	node->errorCode = 0;
 
-	ptrOnNodeInit onNodeInitFunct = (ptrOnNodeInit)GetFunction(node->implementation, "onNodeInit");
-	if (onNodeInitFunct && !node->isInitialized)
+	if (node->vtable->onNodeInit && !node->isInitialized)
 	{
-		onNodeInitFunct(node);
+		node->vtable->onNodeInit(node);
 		node->isInitialized = 1;
 	}
 
-	ptrExecuteAction executeActionFunct = (ptrExecuteAction)GetFunction(node->implementation, "executeAction");
-	if (executeActionFunct)
+	if (node->vtable->executeAction)
 	{
 		node->started = time(NULL);
-		executeActionFunct(node);
+		node->vtable->executeAction(node);
 	}
+
+	common_stats_record_execution(node, common_get_time_ns() - startNs, node->errorCode != 0);
+	common_trace_end(TRACE_NODE_EXECUTION, node, traceBegin);
 }
 
 /**
@@ -289,6 +426,8 @@ void RunNodeInterfaces(Node* node)
 *		+) if has already been executed, then it's in paused state. In this case, just signal the node thread.
 *		+) if hasn't been executed, then start it in new thread (simillar like entry points are started in StartLoops function)
 *
+* If node is still running, wait until it finishes. Waiting doesn't use CPU and is counted in node's runningWaitsCnt.
+*
 * Here, also list of nodes that are going to be stopped is filled:
 *		+) Go through each true and false parent of the node that is going to be started
 *		+) Check if it's in STOPPED state, and doesn't exists already in stopped nodes list
@@ -303,23 +442,31 @@ void RunNodeInterfaces(Node* node)
 void StartOrSignalNodes(Node** nodes, int startNodesCnt, Node **stopNodeList, int *iStopNodesListCnt)
 {
 	int i;
+	uint64_t traceBegin;
+
 	for (i = 0; i < startNodesCnt; i++)
 	{
-		pthread_mutex_lock(&_node_locks[nodes[i]->nodeLockId]);
-		while (strcmp(nodes[i]->status, "RUNNING") == 0)
+		traceBegin = common_trace_begin();
+		pthread_mutex_lock(&nodes[i]->sync.nodeLock);
+		common_trace_end(TRACE_NODE_LOCK, nodes[i], traceBegin);
+		ATOMIC_ADD(&nodes[i]->statusWaitersCnt, 1);
+		if (ATOMIC_LOAD(&nodes[i]->status) == NODE_STATUS_RUNNING)
 		{
-			printf("Node %s is running....\n", nodes[i]->id);
-			//Sleep(10);
+			nodes[i]->runningWaitsCnt++;
+			do
+				pthread_cond_wait(&nodes[i]->sync.finishCondition, &nodes[i]->sync.nodeLock);
+			while (ATOMIC_LOAD(&nodes[i]->status) == NODE_STATUS_RUNNING);
 		}
+		ATOMIC_ADD(&nodes[i]->statusWaitersCnt, -1);
 
-		AddStopParentsToList(nodes[i]->ptrTrueParents, nodes[i]->trueParentsCnt, stopNodeList, iStopNodesListCnt);
-		AddStopParentsToList(nodes[i]->ptrFalseParents, nodes[i]->falseParentsCnt, stopNodeList, iStopNodesListCnt);
+		AddStopParentsToList(nodes[i]->trueParents, nodes[i]->trueParentsCnt, stopNodeList, iStopNodesListCnt);
+		AddStopParentsToList(nodes[i]->falseParents, nodes[i]->falseParentsCnt, stopNodeList, iStopNodesListCnt);
 		if (!nodes[i]->isStarted)
 			SafeNodeStart(nodes[i]);
 		else
-			common_signal_pause_condition(nodes[i]->pauseNodeConditionId);
+			SignalNode(nodes[i]);
 
-		pthread_mutex_unlock(&_node_locks[nodes[i]->nodeLockId]);
+		pthread_mutex_unlock(&nodes[i]->sync.nodeLock);
 	}
 }
 //************************************************************************/
@@ -342,12 +489,14 @@ void StartOrSignalNodes(Node** nodes, int startNodesCnt, Node **stopNodeList, in
 void ExecuteMainThreadActions()
 {
 	int i, j;
+
+	AllocateTriggerLists();
+
 	for (i = 0; i < COMMON_NODE_LIST_LENGTH; i++)
 	{
 		// Fire onNodePreInit event
-		ptrOnNodePreInit onNodePreInit = (ptrOnNodePreInit)GetFunction(COMMON_NODE_LIST[i]->implementation, "onNodePreInit");
-		if (NULL != onNodePreInit)
-			onNodePreInit(COMMON_NODE_LIST[i]);
+		if (NULL != COMMON_NODE_LIST[i]->vtable->onNodePreInit)
+			COMMON_NODE_LIST[i]->vtable->onNodePreInit(COMMON_NODE_LIST[i]);
 
 		// Fill buffer triggers
 		if (strcmp(common_get_node_arg(COMMON_NODE_LIST[i], "__BUFFER_TRIGGERS__"), "") != 0)
@@ -359,27 +508,76 @@ void ExecuteMainThreadActions()
 			char **bufferTriggers = NULL;
 			common_str_split(common_get_node_arg(COMMON_NODE_LIST[i], "__BUFFER_TRIGGERS__"), ",", &numBufferTriggers, &bufferTriggers);
 
+			COMMON_NODE_LIST[i]->bufferedEvents = common_project_arena_alloc(sizeof(buffer_t));
 			if (strcmp(common_get_node_arg(COMMON_NODE_LIST[i], "__EVENTS_BUFFER_LENGTH__"), "") == 0)
-				common_init_buffer(&COMMON_NODE_LIST[i]->bufferedEvents, MAX_EVENT_QUEUE_LENGTH);
+				common_init_buffer(COMMON_NODE_LIST[i]->bufferedEvents, MAX_EVENT_QUEUE_LENGTH);
 			else
-				common_init_buffer(&COMMON_NODE_LIST[i]->bufferedEvents, atoi(common_get_node_arg(COMMON_NODE_LIST[i], "__EVENTS_BUFFER_LENGTH__")));
+				common_init_buffer(COMMON_NODE_LIST[i]->bufferedEvents, atoi(common_get_node_arg(COMMON_NODE_LIST[i], "__EVENTS_BUFFER_LENGTH__")));
+
+			common_set_buffer_overflow_policy(COMMON_NODE_LIST[i]->bufferedEvents, common_get_node_arg(COMMON_NODE_LIST[i], "__BUFFER_OVERFLOW_POLICY__"), atoi(common_get_node_arg(COMMON_NODE_LIST[i], "__BUFFER_OVERFLOW_TIMEOUT__")));
+
+			// Opt-in batch mode : triggering node receives up to __EVENTS_BATCH_SIZE__ buffered events per execution
+			if (atoi(common_get_node_arg(COMMON_NODE_LIST[i], "__EVENTS_BATCH_SIZE__")) > 1)
+				common_init_events_batch(COMMON_NODE_LIST[i], atoi(common_get_node_arg(COMMON_NODE_LIST[i], "__EVENTS_BATCH_SIZE__")));
 
 			// Go through splitted trigger nodes
 			for (j = 0; j < numBufferTriggers; j++)
 			{
 				// Find trigger node (eg Debug1)
 				Node* triggerNode = common_get_node_by_id(bufferTriggers[j]);
-				if (triggeringNode->nodesToTrigger == NULL)
-					triggerNode->nodesToTrigger = malloc(100 * sizeof(Node*));
+				if (triggerNode == NULL)
+					continue;
 
 				// Add triggering node to trigger node (eg OpcUaClientSubs to Debug1)
-				triggerNode->nodesToTrigger[triggerNode->nodesToTriggerCnt] = (Node*)malloc(sizeof(Node*));
 				triggerNode->nodesToTrigger[triggerNode->nodesToTriggerCnt++] = triggeringNode;
 
 				printf("%s added to %s triggering nodes list...\n", triggeringNode->id, triggerNode->id);
 			}
 			common_free_splitted_string(bufferTriggers, numBufferTriggers);
 		}
+		// Eventable node without trigger nodes. Nobody pulls events from its buffer, so smallest one is enough
+		else if (!COMMON_NODE_LIST[i]->isActionable)
+		{
+			COMMON_NODE_LIST[i]->bufferedEvents = common_project_arena_alloc(sizeof(buffer_t));
+			common_init_buffer(COMMON_NODE_LIST[i]->bufferedEvents, 1);
+		}
+	}
+}
+
+/**
+* Allocates trigger nodes lists. Triggering nodes are counted for each trigger node first,
+* so that each list is allocated with exact size. Lists are filled in ExecuteMainThreadActions
+*
+* @return	void
+*/
+void AllocateTriggerLists()
+{
+	int i;
+	const char* rest;
+	strSpan token;
+	Node* triggerNode;
+
+	for (i = 0; i < COMMON_NODE_LIST_LENGTH; i++)
+	{
+		rest = common_get_node_arg(COMMON_NODE_LIST[i], "__BUFFER_TRIGGERS__");
+		if (strcmp(rest, "") == 0)
+			continue;
+
+		while (common_str_next_token(&rest, ",", &token))
+		{
+			triggerNode = common_get_node_by_span(token.start, token.length);
+			if (triggerNode != NULL)
+				triggerNode->nodesToTriggerCnt++;
+		}
+	}
+
+	for (i = 0; i < COMMON_NODE_LIST_LENGTH; i++)
+	{
+		if (COMMON_NODE_LIST[i]->nodesToTriggerCnt == 0)
+			continue;
+
+		COMMON_NODE_LIST[i]->nodesToTrigger = common_project_arena_alloc(COMMON_NODE_LIST[i]->nodesToTriggerCnt * sizeof(Node*));
+		COMMON_NODE_LIST[i]->nodesToTriggerCnt = 0;
 	}
 }
 
@@ -387,22 +585,22 @@ void ExecuteMainThreadActions()
 * Fills list of nodes, that are going to be stopped.
 * Add it to the list if it's in STOPPED state, and doesn't exists already in stopped nodes list
 *
-* @param	nodes				true or false parents list (depending of call from calee)
-* @param	stopNodesCnt		how many nodes are on true or false parents list
+* @param	parents				true or false parents row (depending of call from calee)
+* @param	stopNodesCnt		how many nodes are on true or false parents row
 * @param	stopNodeList		list of nodes that are going to be stopped. This is output argument.
 * @param	iStopNodesListCnt	how many nodes are going to be stopped. This is output argument.
 * @return	void
 */
-void AddStopParentsToList(Node **nodes, int stopNodesCnt, Node **stopNodeList, int *iStopNodesListCnt)
+void AddStopParentsToList(const uint32_t* parents, int stopNodesCnt, Node **stopNodeList, int *iStopNodesListCnt)
 {
 	int i;
-	if (nodes == NULL)
-		return;
+	Node* parent;
 
 	for (i = 0; i < stopNodesCnt; i++)
 	{
-		if (strcmp(((Node*)nodes[i])->status, "STOPPED") != 0 && !common_node_exists(stopNodeList, ((Node*)nodes[i]), (*iStopNodesListCnt)))
-			stopNodeList[(*iStopNodesListCnt)++] = nodes[i];
+		parent = &_nodes[parents[i]];
+		if (ATOMIC_LOAD(&parent->status) != NODE_STATUS_STOPPED && !common_node_exists(stopNodeList, parent, (*iStopNodesListCnt)))
+			stopNodeList[(*iStopNodesListCnt)++] = parent;
 	}
 }
 
@@ -436,6 +634,81 @@ void ReadZenFile(char zenFileName[MAX_PATH], char **input)
 	fclose(fp);
 }
 
+/**
+* Estimates how much project arena is needed for nodes, arguments, implementations and relations,
+* so that project load makes single system allocation
+*
+* @return	estimated size in bytes
+*/
+size_t EstimateProjectArenaSize()
+{
+	const projectImageHeader* header = _projectImage.header;
+	size_t size = 0;
+	uint32_t i;
+
+	// Arena allocations are rounded up to 16 bytes, so each one is counted with 16 extra bytes
+	size += header->implementationsCnt * (sizeof(struct Implementation*) + sizeof(struct Implementation) + 16) + 16;
+	size += (header->nodesCnt + 1) * (sizeof(Node) + sizeof(nodeColdData) + 2 * sizeof(int)) + 48;
+	size += (header->nodesCnt + 1) * (sizeof(struct nodeContextParamsStruct) + sizeof(pthread_t) + sizeof(pthread_mutex_t)) + 48;
+	size += (header->nodesCnt + 16) * 5 * sizeof(Node*) + 32;
+	size += header->nodesCnt * (sizeof(buffer_t) + 32);
+	size += 2 * ((header->nodesCnt + 2) * sizeof(uint32_t) + 16) + (header->trueChildsCnt + header->falseChildsCnt + 2) * sizeof(uint32_t) + 32;
+	for (i = 0; i < header->argsCnt; i++)
+		size += sizeof(nodeArgs*) + sizeof(nodeArgs) + strlen(GetImageString(&_projectImage, _projectImage.args[i].key)) + strlen(GetImageString(&_projectImage, _projectImage.args[i].value)) + 50;
+	return size;
+}
+
+/**
+* Prints how much memory project load used
+*
+* @return	void
+*/
+void PrintProjectArenaStats()
+{
+	projectArenaStats stats;
+	common_get_project_arena_stats(&stats);
+	printf("Project arena : %d block(s), %lu of %lu bytes used\n\n", stats.blocksCnt, (unsigned long)stats.used, (unsigned long)stats.size);
+}
+
+/**
+* Loads project image. If image is missing or stale (.zen files were changed), project is compiled
+* from .zen files and image is saved, so that next start maps it without parsing
+*
+* @param	isCompileOnly	compile and save image even if existing one is up to date
+* @return	0 on success
+*/
+int LoadProjectImage(int isCompileOnly)
+{
+	char* inputs[3];
+	uint64_t inputsHash;
+	int rc = 0;
+
+	ReadZenFile(_implementations_file, &inputs[0]);
+	ReadZenFile(_nodes_file, &inputs[1]);
+	ReadZenFile(_relations_file, &inputs[2]);
+	inputsHash = HashProjectInputs(inputs, 3);
+
+	if (!isCompileOnly && MapProjectImage(_image_file, inputsHash, &_projectImage) == 0)
+		printf("Project image %s mapped...\n", _image_file);
+	else if (CompileProjectImage(inputs[0], inputs[1], inputs[2], inputsHash, &_projectImage) != 0)
+	{
+		fprintf(stderr, "Could not compile project...\n");
+		rc = 1;
+	}
+	else if (SaveProjectImage(&_projectImage, _image_file) != 0)
+		fprintf(stderr, "Could not save project image %s. Project will be compiled again on next start...\n", _image_file);
+	else
+		printf("Project image %s compiled...\n", _image_file);
+
+	if (rc == 0)
+		common_project_arena_reserve(EstimateProjectArenaSize());
+
+	free(inputs[0]);
+	free(inputs[1]);
+	free(inputs[2]);
+	return rc;
+}
+
 /**
 * Searches for first folder under project root. Folder name is project id
 * Only one folder, with project id as name, can be under project root!!!
@@ -560,6 +833,7 @@ void SetPaths()
 	snprintf(_implementations_file, sizeof(_implementations_file), "%s%s", _project_root, "/DB/Implementations.zen");
 	snprintf(_relations_file, sizeof(_relations_file), "%s%s", _project_root, "/DB/Relations.zen");
 	snprintf(_nodes_file, sizeof(_nodes_file), "%s%s", _project_root, "/DB/Modules.zen");
+	snprintf(_image_file, sizeof(_image_file), "%s%s%s", _project_root, "/DB/", PROJECT_IMAGE_FILE_NAME);
 	snprintf(_implementations_path, sizeof(_implementations_path), "%s%s", _project_root, "/Implementations/");
 }
 //************************************************************************/
@@ -571,52 +845,26 @@ void SetPaths()
 //************************************************************************/
 
 /**
-* Fills implementations from implementation file
+* Fills implementations from project image
 *
 * @return	void
 */
 int FillImplementationList()
 {
-	char *input = 0;
-	int i;
-
-	ReadZenFile(_implementations_file, &input);
-	int numImplementations = 0;
+	uint32_t i;
+	const projectImageImplementation* imageImplementation;
 
-	//Split implementations
-	char **implementations = NULL;
-	common_str_split(input, ";", &numImplementations, &implementations);
-
-	for (i = 0; i < numImplementations; i++)
+	_implementationList = common_project_arena_alloc(_projectImage.header->implementationsCnt * sizeof(struct Implementation*));
+	for (i = 0; i < _projectImage.header->implementationsCnt; i++)
 	{
-		if (strcmp(implementations[i], "") == 0)
-			break;
-
-		if (_implementationList == NULL)
-			_implementationList = malloc(sizeof(struct Implementation*));
-		else
-		{
-			struct Implementation **tmpImp = realloc(_implementationList, (_implementationCount + 1) * sizeof *_implementationList);
-			if (tmpImp == NULL)
-			{
-				fprintf(stderr, "could not allocate implementation...");
-				getchar();
-				exit(1);
-			}
-			else
-				_implementationList = tmpImp;
-		}
+		imageImplementation = &_projectImage.implementations[i];
 
 		//Get basic implementation data
 		char tmpImpFile[MAX_PATH] = "";
-		struct Implementation *implementation = malloc(sizeof(struct Implementation));
-		int numImplementation = 0;
-		char** tokens = NULL;
-		common_str_split(implementations[i], ",", &numImplementation, &tokens);
-		sscanf(tokens[0], "%s", implementation->fileName);
-		sscanf(tokens[1], "%s", implementation->id);
-		sscanf(tokens[3], "%s", implementation->params);
-		common_free_splitted_string(tokens, numImplementation);
+		struct Implementation *implementation = common_project_arena_alloc(sizeof(struct Implementation));
+		snprintf(implementation->fileName, sizeof(implementation->fileName), "%s", GetImageString(&_projectImage, imageImplementation->fileName));
+		snprintf(implementation->id, sizeof(implementation->id), "%s", GetImageString(&_projectImage, imageImplementation->id));
+		snprintf(implementation->params, sizeof(implementation->params), "%s", GetImageString(&_projectImage, imageImplementation->params));
 
 		//Load implementation shared library
 		snprintf(tmpImpFile, sizeof(tmpImpFile), "%s%s", _implementations_path, implementation->fileName);
@@ -629,82 +877,103 @@ int FillImplementationList()
 			exit(1);
 		}
 		implementation->hDLL = hDLL;
+		FillImplementationVTable(hDLL, &implementation->vtable);
 
 		// Check if executeAction exists
 		//	* if does, then this is actionable node
 		//	* else, it's eventable
-		if ((ptrExecuteAction)GetFunction(hDLL, "executeAction"))
+		if (implementation->vtable.executeAction)
 			strncpy(implementation->type, ELEMENT_TYPE_ACTION, strlen(ELEMENT_TYPE_ACTION) + 1);
 		else
 			strncpy(implementation->type, ELEMENT_TYPE_EVENT, strlen(ELEMENT_TYPE_EVENT) + 1);
 
 		//Call OnImplementationInit function. This function is called on main thread, and it's thread safe
-		ptrOnImplementationInit onImplementationInitFunct = (ptrOnImplementationInit)GetFunction(hDLL, "onImplementationInit");
-		if (onImplementationInitFunct)
-			onImplementationInitFunct(implementation->params);
+		if (implementation->vtable.onImplementationInit)
+			implementation->vtable.onImplementationInit(implementation->params);
 
-		//Add implementation to implementation list, and reallocate list properly
+		//Add implementation to implementation list
 		_implementationList[i] = implementation;
 		_implementationCount++;
 	}
-	//for (int i = 0; i < numImplementations; i++)
-	//	free(implementations[i]);
-
-	common_free_splitted_string(implementations, numImplementations);
-	free(input);
 	return 0;
 }
 
 /**
-* Fills nodes from node file
+* Resolves all known Element entry points from implementation shared library.
+* This is done only once per implementation, so that nodes don't need to look them up on every execution.
 *
+* @param	hDLL	implementation shared library
+* @param	vtable	entry points (output argument)
 * @return	void
 */
-void FillNodeList()
+void FillImplementationVTable(void* hDLL, ImplementationVTable* vtable)
 {
-	char *input = 0;
-	int i, j;
-
-	ReadZenFile(_nodes_file, &input);
-	cJSON *root = cJSON_Parse(input);
+	vtable->onImplementationInit = (ptrOnImplementationInit)GetFunction(hDLL, "onImplementationInit");
+	vtable->onNodePreInit = (ptrOnNodePreInit)GetFunction(hDLL, "onNodePreInit");
+	vtable->onNodeInit = (ptrOnNodeInit)GetFunction(hDLL, "onNodeInit");
+	vtable->executeAction = (ptrExecuteAction)GetFunction(hDLL, "executeAction");
+	vtable->onSubscribeNodeToEvent = (ptrSubscribeNodeToEvent)GetFunction(hDLL, "onSubscribeNodeToEvent");
+	vtable->getNodesToExecute = (ptrOnGetNodesToExecute)GetFunction(hDLL, "getNodesToExecute");
+	vtable->onNodeEvent = (ptrOnNodeEvent)GetFunction(hDLL, "onNodeEvent");
+	vtable->onNodeComplete = (ptrOnNodeComplete)GetFunction(hDLL, "onNodeComplete");
+}
 
-	int nodesCount = cJSON_GetArraySize(root);
-	common_initialize_node_list(nodesCount);
-	for (i = 0; i < nodesCount; i++)
+/**
+* Fills nodes from project image
+*
+* @return	void
+*/
+void FillNodeList()
+{
+	uint32_t i, k;
+	int j;
+	const projectImageNode* imageNode;
+	const projectImageArg* imageArg;
+
+	// Nodes and their scheduling state are allocated once, in contiguous arrays
+	common_initialize_node_list(_projectImage.header->nodesCnt);
+	_nodes = common_project_arena_alloc((_projectImage.header->nodesCnt + 1) * sizeof(Node));
+	_nodes_cold_data = common_project_arena_alloc((_projectImage.header->nodesCnt + 1) * sizeof(nodeColdData));
+	_scheduling.satisfiedParentsCnt = common_project_arena_alloc(2 * (_projectImage.header->nodesCnt + 1) * sizeof(int));
+	_scheduling.requiredParentsCnt = (int*)_scheduling.satisfiedParentsCnt + _projectImage.header->nodesCnt + 1;
+	_node_contexts = common_project_arena_alloc((_projectImage.header->nodesCnt + 1) * sizeof(struct nodeContextParamsStruct));
+	_node_threads = common_project_arena_alloc((_projectImage.header->nodesCnt + 1) * sizeof(pthread_t));
+
+	for (i = 0; i < _projectImage.header->nodesCnt; i++)
 	{
-		cJSON *subitem = cJSON_GetArrayItem(root, i);
-		Node *node = malloc(sizeof(Node));
-
-		cJSON* tmpNodeProperties = cJSON_GetObjectItem(subitem, "ELEMENT_PROPERTIES");
-		cJSON *nodeProperties = tmpNodeProperties->child;
-		node->argsCnt = cJSON_GetArraySize(tmpNodeProperties);
-		node->args = malloc(node->argsCnt * sizeof(nodeArgs*));
-		int iCnt = 0;
-		while (nodeProperties)
+		imageNode = &_projectImage.nodes[i];
+		Node *node = &_nodes[i];
+		node->id = _nodes_cold_data[i].id;
+		node->implementationId = _nodes_cold_data[i].implementationId;
+		node->errorMessage = _nodes_cold_data[i].errorMessage;
+
+		node->argsCnt = imageNode->argsCnt;
+		node->args = common_project_arena_alloc(node->argsCnt * sizeof(nodeArgs*));
+		for (k = 0; k < imageNode->argsCnt; k++)
 		{
-			node->args[iCnt] = malloc(sizeof(nodeArgs));
-			node->args[iCnt]->Key = malloc(strlen(nodeProperties->string) * sizeof(char) + 1);
-			node->args[iCnt]->Value = malloc(strlen(nodeProperties->valuestring) * sizeof(char) + 1);
-			
-			strncpy(node->args[iCnt]->Key, nodeProperties->string, strlen(nodeProperties->string) + 1);
-			strncpy(node->args[iCnt]->Value, nodeProperties->valuestring, strlen(nodeProperties->valuestring) + 1);
-			
-			nodeProperties = nodeProperties->next;
-			iCnt++;
+			imageArg = &_projectImage.args[imageNode->firstArg + k];
+			node->args[k] = common_create_node_arg((char*)GetImageString(&_projectImage, imageArg->key), (char*)GetImageString(&_projectImage, imageArg->value));
 		}
 
-		strncpy(node->id, cJSON_GetObjectItem(subitem, "ELEMENT_NAME")->valuestring, strlen(cJSON_GetObjectItem(subitem, "ELEMENT_NAME")->valuestring) + 1);
-		strncpy(node->implementationId, cJSON_GetObjectItem(subitem, "IMPLEMENTATION")->valuestring, strlen(cJSON_GetObjectItem(subitem, "IMPLEMENTATION")->valuestring) + 1);
-		strncpy(node->nodeOperator, cJSON_GetObjectItem(subitem, "OPERATOR")->valuestring, strlen(cJSON_GetObjectItem(subitem, "OPERATOR")->valuestring) + 1);
+		snprintf(node->id, NODE_ID_LENGTH, "%s", GetImageString(&_projectImage, imageNode->id));
+		snprintf(node->implementationId, NODE_ID_LENGTH, "%s", GetImageString(&_projectImage, imageNode->implementationId));
+		node->nodeOperator = imageNode->nodeOperator;
 
 		node->lastResult = NULL;
+		memset(node->resultSlots, 0, sizeof(node->resultSlots));
+		node->resultSequence = 0;
+		memset((void*)node->resultReadersCnt, 0, sizeof(node->resultReadersCnt));
+		memset(node->retiredResults, 0, sizeof(node->retiredResults));
 		node->isInitialized = 0;
 		node->isStarted = 0;
 		node->isConditionMet = 1;
+		node->publishedConditionMet = 1;
 		node->loopLockId = -1;
-		node->pauseNodeConditionId = -1;
-		node->ptrTrueParents = NULL;
-		node->ptrFalseParents = NULL;
+		node->index = i;
+		node->trueChilds = NULL;
+		node->falseChilds = NULL;
+		node->trueParents = NULL;
+		node->falseParents = NULL;
 		node->falseChildsCnt = 0;
 		node->falseParentsCnt = 0;
 		node->trueChildsCnt = 0;
@@ -714,15 +983,26 @@ void FillNodeList()
 		node->disconnectedNodesCnt = 0;
 		node->nodesToTrigger = NULL;
 		node->nodesToTriggerCnt = 0;
+		node->bufferedEvents = NULL;
+		node->batchedEvents = NULL;
 		node->isEventActive = 0;
 		node->hasGreenLight = 1;
-		strncpy(node->status, "", 1);
+		node->isQueued = 0;
+		node->nextQueued = NULL;
+		node->readyNs = 0;
+		node->statsBlocks = NULL;
+		node->runningWaitsCnt = 0;
+		node->status = NODE_STATUS_IDLE;
+		node->statusWaitersCnt = 0;
+		node->implementation = NULL;
+		node->vtable = &_empty_vtable;
 
 		for (j = 0; j < _implementationCount; j++)
 		{
 			if (strcmp(node->implementationId, _implementationList[j]->id) == 0)
 			{
 				node->implementation = _implementationList[j]->hDLL;
+				node->vtable = &_implementationList[j]->vtable;
 				if (strcmp(_implementationList[j]->type, "ACTION") == 0)
 					node->isActionable = 1;
 				else
@@ -731,138 +1011,106 @@ void FillNodeList()
 					common_init_event_queue_lock(node);
 				}
 
-				ptrSubscribeNodeToEvent subscribeNodeToEvent = (ptrSubscribeNodeToEvent)GetFunction(_implementationList[j]->hDLL, "onSubscribeNodeToEvent");
-				if (NULL != subscribeNodeToEvent)
+				if (NULL != node->vtable->onSubscribeNodeToEvent)
 				{
-					int tmp = subscribeNodeToEvent(node);
+					int tmp = node->vtable->onSubscribeNodeToEvent(node);
 				}
 			}
 		}
 
-		pthread_mutex_init(&_node_locks[_node_locks_cnt++], NULL);
-		node->nodeLockId = _node_locks_cnt - 1;
+		pthread_cond_init(&node->sync.finishCondition, NULL);
+		pthread_mutex_init(&node->sync.nodeLock, NULL);
 
 		common_add_node_to_list(node);
 	}
-	cJSON_Delete(root);
-	free(input);
 }
 
 /**
-* Fills relations from relation file and manages first level parent / child relations
+* Builds parent rows from child rows. Parents in each row are in node order
+*
+* @param	childRows	child row offsets, nodes count + 1
+* @param	childs		child node indices
+* @param	nodesCnt	nodes count
+* @param	parents		parent node indices (output argument)
+* @return	parent row offsets, nodes count + 1
+*/
+uint32_t* BuildParentRows(const uint32_t* childRows, const uint32_t* childs, uint32_t nodesCnt, uint32_t** parents)
+{
+	uint32_t i, j;
+	uint32_t* rows = common_project_arena_alloc((nodesCnt + 2) * sizeof(uint32_t));
+
+	*parents = common_project_arena_alloc((childRows[nodesCnt] + 1) * sizeof(uint32_t));
+
+	// Counts are shifted by two, so that after prefix sum rows[child + 1] is insert position of child's row.
+	// When rows are filled, insert positions become row ends, which are offsets of next rows
+	for (j = 0; j < childRows[nodesCnt]; j++)
+		rows[childs[j] + 2]++;
+	for (i = 2; i < nodesCnt + 2; i++)
+		rows[i] += rows[i - 1];
+	for (i = 0; i < nodesCnt; i++)
+		for (j = childRows[i]; j < childRows[i + 1]; j++)
+			(*parents)[rows[childs[j] + 1]++] = i;
+
+	return rows;
+}
+
+/**
+* Fills relations from project image and manages first level parent / child relations.
+* Nodes point to their rows in CSR relation arrays
 *
 * @return	void
 */
 void FillRelationList()
 {
-	//id,true_child_1|true_child_2,false_child_1
-	char *input = 0;
-	int numRelations = 0, i, j, k, iRel;
+	uint32_t i, nodesCnt = _projectImage.header->nodesCnt;
+	int j, k;
+	Node *node;
 
-	ReadZenFile(_relations_file, &input);
+	_true_parent_rows = BuildParentRows(_projectImage.trueChildRows, _projectImage.trueChilds, nodesCnt, &_true_parents);
+	_false_parent_rows = BuildParentRows(_projectImage.falseChildRows, _projectImage.falseChilds, nodesCnt, &_false_parents);
 
 	printf("------------DEFINING RELATIONS-------------\n");
-	//split relations, handle them one by one
-	char **relations = NULL;
-	common_str_split(input, ";", &numRelations, &relations);
-	for (i = 0; i < numRelations; i++)
+	for (i = 0; i < nodesCnt; i++)
 	{
-		int numRelation = 0;
-		char **relation = NULL;
-		common_str_split(relations[i], ",", &numRelation, &relation);
-		if (strcmp(*relation, "") == 0)
+		node = &_nodes[i];
+		node->trueChilds = &_projectImage.trueChilds[_projectImage.trueChildRows[i]];
+		node->trueChildsCnt = _projectImage.trueChildRows[i + 1] - _projectImage.trueChildRows[i];
+		node->falseChilds = &_projectImage.falseChilds[_projectImage.falseChildRows[i]];
+		node->falseChildsCnt = _projectImage.falseChildRows[i + 1] - _projectImage.falseChildRows[i];
+		node->trueParents = &_true_parents[_true_parent_rows[i]];
+		node->trueParentsCnt = _true_parent_rows[i + 1] - _true_parent_rows[i];
+		node->falseParents = &_false_parents[_false_parent_rows[i]];
+		node->falseParentsCnt = _false_parent_rows[i + 1] - _false_parent_rows[i];
+
+		//Print relations from current node to childs
+		for (k = 0; k < node->trueChildsCnt; k++)
+			printf("%s --> %s\n", node->id, _nodes[node->trueChilds[k]].id);
+		for (k = 0; k < node->falseChildsCnt; k++)
+			printf("%s --> %s\n", node->id, _nodes[node->falseChilds[k]].id);
+
+		//Current node is true parent to true childs and false parent to false childs
+		for (k = 0; k < node->trueChildsCnt; k++)
 		{
-			common_free_splitted_string(relation, numRelation);
-			break;
+			if (node->publishedConditionMet)
+				_scheduling.satisfiedParentsCnt[node->trueChilds[k]]++;
+			printf("%s <-- %s\n", node->id, _nodes[node->trueChilds[k]].id);
 		}
-		char id[50], trueChilds[FIRST_LEVEL_RELATIONS_STRING_LENGTH] = "", falseChilds[FIRST_LEVEL_RELATIONS_STRING_LENGTH] = "";
-		//Node Id
-		sscanf(relation[0], "%s", id);
-
-		//True childs, separated by |
-		if (relation[1] != NULL)
-			sscanf(relation[1], "%s", trueChilds);
-
-		//False childs, separated by |
-		if (relation[2] != NULL)
-			sscanf(relation[2], "%s", falseChilds);
-
-		for (j = 0; j < COMMON_NODE_LIST_LENGTH; j++)
+		for (k = 0; k < node->falseChildsCnt; k++)
 		{
-			//Find node that matches id field from relation string
-			if (strcmp(COMMON_NODE_LIST[j]->id, id) == 0)
-			{
-				//Split true childs by | separator
-				int numTrueChilds = 0;
-				char** ptrTrueChilds = NULL;
-				common_str_split(trueChilds, "|", &numTrueChilds, &ptrTrueChilds);
-
-				//Split false childs by | separator
-				int numFalseChilds = 0;
-				char** ptrFalseChilds = NULL;
-				common_str_split(falseChilds, "|", &numFalseChilds, &ptrFalseChilds);
-
-				if (numTrueChilds > 0 && strcmp(*ptrTrueChilds, "") != 0)
-				{
-					//Set true childs node array
-					Node **tmpArrTrueChilds = malloc((numTrueChilds) * sizeof(Node*));
-					common_parse_nodes(tmpArrTrueChilds, ptrTrueChilds, numTrueChilds);
-					COMMON_NODE_LIST[j]->ptrTrueChilds = tmpArrTrueChilds;
-					COMMON_NODE_LIST[j]->trueChildsCnt = numTrueChilds;
-
-					//Print relations from current node to childs
-					for (iRel = 0; iRel < numTrueChilds; iRel++)
-						printf("%s --> %s\n", id, COMMON_NODE_LIST[j]->ptrTrueChilds[iRel]->id);
-
-					//Add contra relation. Current node is true parent to true childs
-					for (k = 0; k < numTrueChilds; k++)
-					{
-						if (tmpArrTrueChilds[k]->ptrTrueParents == NULL)
-							tmpArrTrueChilds[k]->ptrTrueParents = malloc(sizeof(Node*));
-						else
-							tmpArrTrueChilds[k]->ptrTrueParents = realloc(tmpArrTrueChilds[k]->ptrTrueParents, (tmpArrTrueChilds[k]->trueParentsCnt + 1) * sizeof(Node*));
-
-						tmpArrTrueChilds[k]->ptrTrueParents[tmpArrTrueChilds[k]->trueParentsCnt++] = COMMON_NODE_LIST[j];
-
-						//Print relation from child to current node (parent)
-						printf("%s <-- %s\n", id, tmpArrTrueChilds[k]->id);
-					}
-				}
-
-				if (numFalseChilds > 0 && strcmp(*ptrFalseChilds, "") != 0)
-				{
-					Node **tmpArrFalseChilds = malloc((numFalseChilds) * sizeof(Node*));
-					common_parse_nodes(tmpArrFalseChilds, ptrFalseChilds, numFalseChilds);
-					COMMON_NODE_LIST[j]->ptrFalseChilds = tmpArrFalseChilds;
-					COMMON_NODE_LIST[j]->falseChildsCnt = numFalseChilds;
-
-					//Print relations from current node to childs
-					for (iRel = 0; iRel < numFalseChilds; iRel++)
-						printf("%s --> %s\n", id, COMMON_NODE_LIST[j]->ptrFalseChilds[iRel]->id);
-
-					//Add contra relation
-					for (k = 0; k < numFalseChilds; k++)
-					{
-						if (tmpArrFalseChilds[k]->ptrFalseParents == NULL)
-							tmpArrFalseChilds[k]->ptrFalseParents = (Node**)malloc(sizeof(Node*));
-						else
-							tmpArrFalseChilds[k]->ptrFalseParents = realloc(tmpArrFalseChilds[k]->ptrFalseParents, (tmpArrFalseChilds[k]->falseParentsCnt + 1) * sizeof(Node*));
-
-						tmpArrFalseChilds[k]->ptrFalseParents[tmpArrFalseChilds[k]->falseParentsCnt++] = COMMON_NODE_LIST[j];
-
-						//Print relation from child to current node (parent)
-						printf("%s <-- %s\n", id, tmpArrFalseChilds[k]->id);
-					}
-				}
-				common_free_splitted_string(ptrTrueChilds, numTrueChilds);
-				common_free_splitted_string(ptrFalseChilds, numFalseChilds);
-			}
+			if (!node->publishedConditionMet)
+				_scheduling.satisfiedParentsCnt[node->falseChilds[k]]++;
+			printf("%s <-- %s\n", node->id, _nodes[node->falseChilds[k]].id);
 		}
+	}
 
-		common_free_splitted_string(relation, numRelation);
+	// How many satisfied parents node needs to be started
+	for (j = 0; j < COMMON_NODE_LIST_LENGTH; j++)
+	{
+		if (_nodes[j].nodeOperator == NODE_OPERATOR_AND)
+			_scheduling.requiredParentsCnt[j] = _nodes[j].trueParentsCnt + _nodes[j].falseParentsCnt;
+		else
+			_scheduling.requiredParentsCnt[j] = 1;
 	}
-	common_free_splitted_string(relations, numRelations);
-	free(input);
 	printf("---------END DEFINING RELATIONS-------------\n");
 	printf("\n");
 
@@ -916,13 +1164,12 @@ void MakeVirtualconnections()
 	for (i = 0; i < COMMON_NODE_LIST_LENGTH; i++)
 	{
 		// This is node that can dynamically execute nodes
-		ptrOnGetNodesToExecute onGetNodesToExecuteFunct = (ptrOnGetNodesToExecute)GetFunction(COMMON_NODE_LIST[i]->implementation, "getNodesToExecute");
-		if (onGetNodesToExecuteFunct)
+		if (COMMON_NODE_LIST[i]->vtable->getNodesToExecute)
 		{
 			// Get all nodes that current executor can execute
 			int nodesToExecuteCnt = 0;
 			// Borrow disconnectedNodes filed.
-			COMMON_NODE_LIST[i]->disconnectedNodes = onGetNodesToExecuteFunct(COMMON_NODE_LIST[i], &nodesToExecuteCnt);
+			COMMON_NODE_LIST[i]->disconnectedNodes = COMMON_NODE_LIST[i]->vtable->getNodesToExecute(COMMON_NODE_LIST[i], &nodesToExecuteCnt);
 			COMMON_NODE_LIST[i]->disconnectedNodesCnt = nodesToExecuteCnt;
 		}
 	}
@@ -937,10 +1184,20 @@ void MakeVirtualconnections()
 void SyncLoop()
 {
 	int i, j;
+	int startNodesCnt = 0;
+
+	// There is at most one loop per "Start" node
+	for (i = 0; i < COMMON_NODE_LIST_LENGTH; i++)
+	{
+		if (strcmp(COMMON_NODE_LIST[i]->implementationId, "ZenStart#0#") == 0)
+			startNodesCnt++;
+	}
+	_loop_locks = common_project_arena_alloc((startNodesCnt + 1) * sizeof(pthread_mutex_t));
+
 	for (i = 0; i < COMMON_NODE_LIST_LENGTH; i++)
 	{
 		// Initialize pause condition. Signalling must be unique per node thread
-		COMMON_NODE_LIST[i]->pauseNodeConditionId = common_init_pause_condition();
+		common_init_pause_condition(COMMON_NODE_LIST[i]);
 
 		// Entry sync point are "Start" nodes
 		if (strcmp(COMMON_NODE_LIST[i]->implementationId, "ZenStart#0#") == 0)
@@ -958,11 +1215,10 @@ void SyncLoop()
 
 			// Sync all remaining nodes inside same loop
 			for (j = 0; j < COMMON_NODE_LIST[i]->trueChildsCnt; j++)
-				SyncChilds(COMMON_NODE_LIST[i]->ptrTrueChilds[j], _loop_locks_cnt - 1);
+				SyncChilds(&_nodes[COMMON_NODE_LIST[i]->trueChilds[j]], _loop_locks_cnt - 1);
 
 			for (j = 0; j < COMMON_NODE_LIST[i]->falseChildsCnt; j++)
-				SyncChilds(COMMON_NODE_LIST[i]->ptrFalseChilds[j], _loop_locks_cnt - 1);
-			_loop_locks_cnt++;
+				SyncChilds(&_nodes[COMMON_NODE_LIST[i]->falseChilds[j]], _loop_locks_cnt - 1);
 		}
 	}
 }
@@ -984,16 +1240,16 @@ void SyncChilds(Node *currentNode, int loopLockId)
 	currentNode->loopLockId = loopLockId;
 
 	for (i = 0; i < currentNode->trueChildsCnt; i++)
-		SyncChilds(currentNode->ptrTrueChilds[i], loopLockId);
+		SyncChilds(&_nodes[currentNode->trueChilds[i]], loopLockId);
 
 	for (i = 0; i < currentNode->falseChildsCnt; i++)
-		SyncChilds(currentNode->ptrFalseChilds[i], loopLockId);
+		SyncChilds(&_nodes[currentNode->falseChilds[i]], loopLockId);
 
 	for (i = 0; i < currentNode->trueParentsCnt; i++)
-		SyncChilds(currentNode->ptrTrueParents[i], loopLockId);
+		SyncChilds(&_nodes[currentNode->trueParents[i]], loopLockId);
 
 	for (i = 0; i < currentNode->falseParentsCnt; i++)
-		SyncChilds(currentNode->ptrFalseParents[i], loopLockId);
+		SyncChilds(&_nodes[currentNode->falseParents[i]], loopLockId);
 
 	for (i = 0; i < currentNode->disconnectedNodesCnt; i++)
 		SyncChilds(currentNode->disconnectedNodes[i], loopLockId);
@@ -1022,63 +1278,45 @@ void SyncChilds(Node *currentNode, int loopLockId)
 */
 void OnNodeFinish(Node* node)
 {
-	int i, j;
+	int i;
 	
-	strncpy(node->status, STATUS_ARRIVED, strlen(STATUS_ARRIVED) + 1);
+	SetNodeStatus(node, NODE_STATUS_ARRIVED);
 	//printf("Start Doing : %s\n", node->id);
 
-	// Init start node list
+	// Init start node list. Short lists are kept on stack
 	int startNodesCnt = 0;
-	Node *startNodes[100];
+	Node *startNodesStack[MAX_STACK_NODE_LIST_LENGTH];
+	Node **startNodes = GetNodeListBuffer(startNodesStack, node->trueChildsCnt + node->falseChildsCnt + node->disconnectedNodesCnt);
 
 	// Handle first level true / false node's childs
-	// First step : put true / false childs into the same list
-	Node *trueAndFalseChilds[100];
+	// First step : publish current node condition to childs satisfied parents counters
+	// Second step : put childs, that have enough satisfied parents, to start list
+	PublishNodeCondition(node);
 
 	for (i = 0; i < node->trueChildsCnt; i++)
-		trueAndFalseChilds[i] = node->ptrTrueChilds[i];
+		AddReadyNodeToList(node->trueChilds[i], startNodes, &startNodesCnt);
 
 	for (i = 0; i < node->falseChildsCnt; i++)
-		trueAndFalseChilds[i + node->trueChildsCnt] = node->ptrFalseChilds[i];
-
-	// Second step : for all nodes from previous list check conditions. If condition satisfies requirements, then put child node to start list
-	for (i = 0; i < node->trueChildsCnt + node->falseChildsCnt; i++)
-	{
-		// Initialize conditions
-		int conditions[MAX_CHILD_NODES_COUNT] = { 0 };
-		int cntConditions = 0;
-
-		// Loop through current node child's true parents. Get list of their conditions
-		// For true parent, condition is met when parent condition is true
-		for (j = 0; j < trueAndFalseChilds[i]->trueParentsCnt; j++)
-			conditions[cntConditions++] = trueAndFalseChilds[i]->ptrTrueParents[j]->isConditionMet;
-
-		// Loop through current node child's false parents. Get list of their conditions.
-		// For false parent, condition is met when parent condition is false
-		for (j = 0; j < trueAndFalseChilds[i]->falseParentsCnt; j++)
-			conditions[cntConditions++] = !trueAndFalseChilds[i]->ptrFalseParents[j]->isConditionMet;
-
-		// Check conditions:
-		//		+) when "&"  operator, there must not exists single false condition
-		//		+) when "||" operator, there must be at least one true condition
-		if (!common_node_exists(startNodes, trueAndFalseChilds[i], startNodesCnt)
-			&& (strcmp(trueAndFalseChilds[i]->nodeOperator, "&") == 0 && !common_does_condition_exists(conditions, 0, cntConditions)
-				|| strcmp(trueAndFalseChilds[i]->nodeOperator, "||") == 0 && common_does_condition_exists(conditions, 1, cntConditions)
-				)
-			)
-			startNodes[startNodesCnt++] = trueAndFalseChilds[i];
-	}
+		AddReadyNodeToList(node->falseChilds[i], startNodes, &startNodesCnt);
 
 	// Handle disconnected nodes. Put all nodes on start list, because they are already evaluated in runtime, inside node executers
 	for (i = 0; i < node->disconnectedNodesCnt; i++)
 		startNodes[startNodesCnt++] = node->disconnectedNodes[i];
 
-	// Inform triggering node that we are ready for next round
+	// Inform triggering node that its event is processed and that we are ready for next round
 	for (i = 0; i < node->nodesToTriggerCnt; i++)
+	{
+		if (NULL != node->nodesToTrigger[i]->vtable->onNodeComplete)
+			node->nodesToTrigger[i]->vtable->onNodeComplete(node->nodesToTrigger[i]);
 		common_pull_event_from_buffer(node->nodesToTrigger[i]);
+	}
 
-	// Initialize stop node list
-	Node *stopNodeList[100];
+	// Initialize stop node list. Each start node can add all its parents
+	int stopNodesCapacity = 0;
+	for (i = 0; i < startNodesCnt; i++)
+		stopNodesCapacity += startNodes[i]->trueParentsCnt + startNodes[i]->falseParentsCnt;
+	Node *stopNodeListStack[MAX_STACK_NODE_LIST_LENGTH];
+	Node **stopNodeList = GetNodeListBuffer(stopNodeListStack, stopNodesCapacity);
 	int iStopNodeListCnt = 0;
 
 	// Start nodes from start list
@@ -1088,6 +1326,11 @@ void OnNodeFinish(Node* node)
 	for (i = 0; i < iStopNodeListCnt; i++)
 		stopNodeList[i]->isEventActive = !stopNodeList[i]->unregisterEvent;
 
+	if (startNodes != startNodesStack)
+		free(startNodes);
+	if (stopNodeList != stopNodeListStack)
+		free(stopNodeList);
+
 	if (node->disconnectedNodes != NULL)
 	{
 		free(node->disconnectedNodes);
@@ -1095,14 +1338,201 @@ void OnNodeFinish(Node* node)
 		node->disconnectedNodesCnt = 0;
 	}
 
-	strncpy(node->status, STATUS_STOPPED, strlen(STATUS_STOPPED) + 1);
+	ATOMIC_STORE(&node->status, NODE_STATUS_STOPPED);
 	//printf("End Doing : %s\n", node->id);
 }
+
+/**
+* Returns buffer for node list. Stack buffer is used if list fits in it, otherwise list is allocated
+* and must be freed by caller.
+*
+* @param stackBuffer	stack buffer with MAX_STACK_NODE_LIST_LENGTH elements
+* @param capacity		maximum number of nodes on list
+* @return				node list buffer
+*/
+Node** GetNodeListBuffer(Node** stackBuffer, int capacity)
+{
+	if (capacity <= MAX_STACK_NODE_LIST_LENGTH)
+		return stackBuffer;
+	return malloc(capacity * sizeof(Node*));
+}
+
+/**
+* Publishes node condition to its childs, if it has changed since last publish.
+* Each child keeps count of satisfied parents:
+*		+) for true parent, condition is met when parent condition is true
+*		+) for false parent, condition is met when parent condition is false
+*
+* @param node	node which condition is published
+* @return		void
+*/
+void PublishNodeCondition(Node* node)
+{
+	int i, delta;
+	int isConditionMet = node->isConditionMet != 0;
+
+	if (isConditionMet == node->publishedConditionMet)
+		return;
+
+	node->publishedConditionMet = isConditionMet;
+	delta = isConditionMet ? 1 : -1;
+
+	for (i = 0; i < node->trueChildsCnt; i++)
+		ATOMIC_ADD(&_scheduling.satisfiedParentsCnt[node->trueChilds[i]], delta);
+
+	for (i = 0; i < node->falseChildsCnt; i++)
+		ATOMIC_ADD(&_scheduling.satisfiedParentsCnt[node->falseChilds[i]], -delta);
+}
+
+/**
+* Adds node to start list if enough parents conditions are met and node is not on the list yet:
+*		+) when "&"  operator, all parents must be satisfied
+*		+) when "||" operator, at least one parent must be satisfied
+* Parents counters are checked in scheduling arrays, so node itself is touched only when it's ready
+*
+* @param index				index of node to check
+* @param startNodes		start list
+* @param startNodesCnt		start list length (input / output argument)
+* @return					void
+*/
+void AddReadyNodeToList(uint32_t index, Node** startNodes, int* startNodesCnt)
+{
+	if (ATOMIC_LOAD(&_scheduling.satisfiedParentsCnt[index]) >= _scheduling.requiredParentsCnt[index] && !common_node_exists(startNodes, &_nodes[index], *startNodesCnt))
+		startNodes[(*startNodesCnt)++] = &_nodes[index];
+}
 //**************************************************************************/
 //************************ END MAIN WF PROCEDURE ***************************/
 //**************************************************************************/
 
 
+//**************************************************************************/
+//************************ START BENCH MODE ********************************/
+//**************************************************************************/
+
+/**
+* Returns resident memory size of engine process
+*
+* @return	size in bytes, 0 if it can't be read
+*/
+size_t GetResidentMemorySize()
+{
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return 0;
+	return counters.WorkingSetSize;
+#else
+	long pagesCnt, residentPagesCnt;
+	FILE* file = fopen("/proc/self/statm", "r");
+	if (file == NULL)
+		return 0;
+	if (fscanf(file, "%ld %ld", &pagesCnt, &residentPagesCnt) != 2)
+		residentPagesCnt = 0;
+	fclose(file);
+	return (size_t)residentPagesCnt * (size_t)sysconf(_SC_PAGESIZE);
+#endif
+}
+
+/**
+* Sleeps calling thread
+*
+* @param	ms		sleep time in milliseconds
+* @return	void
+*/
+void BenchSleep(int ms)
+{
+#if defined(_WIN32)
+	Sleep(ms);
+#else
+	struct timespec ts;
+	ts.tv_sec = ms / 1000;
+	ts.tv_nsec = (long)(ms % 1000) * 1000000L;
+	nanosleep(&ts, NULL);
+#endif
+}
+
+/**
+* Sums statistics of all nodes
+*
+* @param	snapshot	summed statistics (output argument)
+* @return	void
+*/
+void TakeBenchSnapshot(benchSnapshot* snapshot)
+{
+	int i;
+	nodeStats stats;
+
+	memset(snapshot, 0, sizeof(benchSnapshot));
+	for (i = 0; i < COMMON_NODE_LIST_LENGTH; i++)
+	{
+		common_get_node_stats(COMMON_NODE_LIST[i], &stats);
+		snapshot->fireCnt += stats.fireCnt;
+		snapshot->errorCnt += stats.errorCnt;
+		snapshot->executionTotalNs += stats.executionTotalNs;
+		snapshot->queueWaitCnt += stats.queueWaitCnt;
+		snapshot->queueWaitTotalNs += stats.queueWaitTotalNs;
+		if (stats.queueWaitMaxNs > snapshot->queueWaitMaxNs)
+			snapshot->queueWaitMaxNs = stats.queueWaitMaxNs;
+	}
+}
+
+/**
+* Measures running project, prints result as one line of JSON prefixed with "BENCH_RESULT " and exits.
+* First fifth of time is warm up, so that thread creation and first fires are not measured.
+* Hop latency is time from node becoming ready (parent finished) to start of its execution,
+* its maximum is cleared at the end of warm up. Elements are informed about end of warm up with common_stats_begin_measurement
+*
+* @param	seconds					measurement time
+* @param	residentSizeBeforeLoad	resident memory size before project was loaded
+* @return	void
+*/
+void RunBench(int seconds, size_t residentSizeBeforeLoad)
+{
+	benchSnapshot first, last;
+	uint64_t startNs, durationNs, firesCnt, hopsCnt;
+	size_t residentSize;
+	projectArenaStats arenaStats;
+	int nodesCnt = COMMON_NODE_LIST_LENGTH;
+	int i;
+
+	BenchSleep(seconds * 200);
+	for (i = 0; i < nodesCnt; i++)
+		common_stats_reset_queue_wait_max(COMMON_NODE_LIST[i]);
+	common_stats_begin_measurement();
+	TakeBenchSnapshot(&first);
+	startNs = common_get_time_ns();
+
+	BenchSleep(seconds * 800);
+	TakeBenchSnapshot(&last);
+	durationNs = common_get_time_ns() - startNs;
+
+	residentSize = GetResidentMemorySize();
+	common_get_project_arena_stats(&arenaStats);
+	firesCnt = last.fireCnt - first.fireCnt;
+	hopsCnt = last.queueWaitCnt - first.queueWaitCnt;
+
+	printf("BENCH_RESULT {\"nodes\":%d,\"fires\":%llu,\"errors\":%llu,\"durationNs\":%llu,\"nodesPerSec\":%.0f,"
+		"\"hopLatencyAvgNs\":%llu,\"hopLatencyMaxNs\":%llu,\"executionAvgNs\":%llu,"
+		"\"arenaBytes\":%llu,\"residentBytes\":%llu,\"memoryPerNodeBytes\":%llu}\n",
+		nodesCnt,
+		(unsigned long long)firesCnt,
+		(unsigned long long)(last.errorCnt - first.errorCnt),
+		(unsigned long long)durationNs,
+		(double)firesCnt * 1000000000.0 / (double)durationNs,
+		(unsigned long long)(hopsCnt > 0 ? (last.queueWaitTotalNs - first.queueWaitTotalNs) / hopsCnt : 0),
+		(unsigned long long)last.queueWaitMaxNs,
+		(unsigned long long)(firesCnt > 0 ? (last.executionTotalNs - first.executionTotalNs) / firesCnt : 0),
+		(unsigned long long)arenaStats.used,
+		(unsigned long long)residentSize,
+		(unsigned long long)(nodesCnt > 0 && residentSize > residentSizeBeforeLoad ? (residentSize - residentSizeBeforeLoad) / nodesCnt : 0));
+	fflush(stdout);
+	exit(0);
+}
+//**************************************************************************/
+//************************ END BENCH MODE **********************************/
+//**************************************************************************/
+
+
 //**************************************************************************/
 //************************ START INI SETIINGS HANDLER **********************/
 //**************************************************************************/
@@ -1160,6 +1590,30 @@ int engineConfigHandler(void* user, const char* section, const char* name, const
 	else if (MATCH("RemoteOperations", "Info")) {
 		pconfig->isRemoteInfoEnabled = 1; //atoi(value);
 	}
+	else if (MATCH("Engine", "ExecutionMode")) {
+		if (strcmp(value, "Pool") == 0)
+			pconfig->executionMode = EXECUTION_MODE_WORKER_POOL;
+		else
+			pconfig->executionMode = EXECUTION_MODE_THREAD_PER_NODE;
+	}
+	else if (MATCH("Engine", "Workers")) {
+		pconfig->workersCnt = atoi(value);
+	}
+	else if (MATCH("Metrics", "Address")) {
+		pconfig->metricsAddress = strdup(value);
+	}
+	else if (MATCH("Metrics", "Port")) {
+		pconfig->metricsPort = atoi(value);
+	}
+	else if (MATCH("Trace", "Enabled")) {
+		pconfig->isTraceEnabled = atoi(value);
+	}
+	else if (MATCH("Trace", "RecordsPerThread")) {
+		pconfig->traceRecordsPerThread = atoi(value);
+	}
+	else if (MATCH("Trace", "File")) {
+		pconfig->traceFile = strdup(value);
+	}
 	else {
 		return 0;  /* unknown section/name, error */
 	}
@@ -22,11 +22,8 @@
 #include "dirent.h"
 #include "ZenCommon.h"
 
-// Max number of child nodes
-#define MAX_CHILD_NODES_COUNT 100
-
-// Max number of all nodes
-#define MAX_NODES_COUNT 1000
+// Node lists in OnNodeFinish up to this length are kept on stack, longer ones are allocated
+#define MAX_STACK_NODE_LIST_LENGTH 64
 
 //Length of project Id
 #define PROJECT_ID_LENGTH 37
@@ -34,27 +31,60 @@
 //Max string length of false and true childs
 #define FIRST_LEVEL_RELATIONS_STRING_LENGTH 512
 
-//Function declarations
-typedef int(*ptrOnImplementationInit)(char*);
-typedef Node**(*ptrOnGetNodesToExecute)(Node*, int*);
-typedef int(*ptrOnNodeInit)(Node*);
-typedef int(*ptrOnNodePreInit)(Node*);
-typedef int(*ptrExecuteAction)(Node*);
-typedef int(*ptrSubscribeNodeToEvent)(Node*);
-typedef int(*ptrOnNodeComplete)(Node*);
+// Cold node data. It's rarely used, so it's kept out of nodes, in separate contiguous array
+typedef struct
+{
+	char id[NODE_ID_LENGTH];
+	char implementationId[NODE_ID_LENGTH];
+	char errorMessage[NODE_ERROR_MESSAGE_LENGTH];
+} nodeColdData;
+
+// Default measurement time of --bench run
+#define BENCH_DEFAULT_SECONDS 5
+
+// Sum of all nodes statistics at one point of --bench run
+typedef struct
+{
+	uint64_t fireCnt;
+	uint64_t errorCnt;
+	uint64_t executionTotalNs;
+	uint64_t queueWaitCnt;
+	uint64_t queueWaitTotalNs;
+	uint64_t queueWaitMaxNs;
+} benchSnapshot;
+
+// Hot scheduling state in structure of arrays form, indexed by node index.
+// Childs readiness is checked on these arrays, without touching child nodes
+typedef struct
+{
+	volatile int* satisfiedParentsCnt;
+	int* requiredParentsCnt;
+} nodeSchedulingState;
 
 int execNode(Node *node);
 void StartNodeCore(Node* node, int* isNodeFirstFires);
 void RunNodeInterfaces(Node* node);
 void StartNode(void *context);
+void ExecuteScheduledNode(Node* node);
+void SignalNode(Node *node);
 void StartLoops();
 void StartOrSignalNodes(Node** nodes, int startNodesCnt, Node **stopNodeList, int *iStopNodesListCnt);
-void AddStopParentsToList(Node **nodes, int stopNodesCnt, Node **stopNodeList, int *iStopNodesListCnt);
+void AllocateTriggerLists();
+void AddStopParentsToList(const uint32_t* parents, int stopNodesCnt, Node **stopNodeList, int *iStopNodesListCnt);
 void OnNodeFinish(Node* node);
+void SetNodeStatus(Node* node, node_status status);
+void PublishNodeCondition(Node* node);
+void AddReadyNodeToList(uint32_t index, Node** startNodes, int* startNodesCnt);
+Node** GetNodeListBuffer(Node** stackBuffer, int capacity);
 void ReadZenFile(char zenFileName[MAX_PATH], char **input);
+size_t EstimateProjectArenaSize();
+void PrintProjectArenaStats();
+int LoadProjectImage(int isCompileOnly);
 void SetProjectId(const char *sDir);
 int FillImplementationList();
+void FillImplementationVTable(void* hDLL, ImplementationVTable* vtable);
 void FillNodeList();
+uint32_t* BuildParentRows(const uint32_t* childRows, const uint32_t* childs, uint32_t nodesCnt, uint32_t** parents);
 void FillRelationList();
 void SyncChilds(Node *currentNode, int loopLockId);
 void SyncLoops();
@@ -64,4 +94,8 @@ void SyncLoop();
 void MakeVirtualconnections();
 void SafeNodeStart(Node *node);
 void ReadEngineConfiguration();
-void DeleteObsoleteNodeFiles();
\ No newline at end of file
+void DeleteObsoleteNodeFiles();
+size_t GetResidentMemorySize();
+void BenchSleep(int ms);
+void TakeBenchSnapshot(benchSnapshot* snapshot);
+void RunBench(int seconds, size_t residentSizeBeforeLoad);
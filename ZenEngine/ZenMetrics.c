@@ -0,0 +1,449 @@
+/*************************************************************************
+ * Copyright (c) 2015, 2018 Zenodys BV
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contributors:
+ *    Tomaž Vinko
+ *   
+ **************************************************************************/
+
+/*=======================================================================================
+|
+|       Metrics endpoint
+|
+|		  * Optional HTTP listener, started when [Metrics] Port is set in Settings.ini.
+|			GET /metrics returns engine and node metrics in Prometheus text exposition format.
+|		  * Node metrics are read from node statistics blocks, event buffer counters and
+|			MQTT counters, which are all lock free. Scrape never takes loop or node locks,
+|			so it can't stall running workflow.
+|		  * Requests are served one by one on listener thread.
+|
++----------------------------------------------------------------------------------------
+|
+|   Known Bugs:		* Counters of running node can be one execution behind
+|
+|	     To Do:		* none
+*==========================================================================================*/
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#endif
+#include "ZenMetrics.h"
+#include "ZenEngine.h"
+#include "ZenScheduler.h"
+#include "pthread.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+
+#if defined(_WIN32)
+typedef SOCKET metricsSocket;
+#define CloseMetricsSocket closesocket
+#define METRICS_SEND_FLAGS 0
+#else
+typedef int metricsSocket;
+#define INVALID_SOCKET -1
+#define CloseMetricsSocket close
+// Scraper can close connection before response is sent. Don't let it kill engine with SIGPIPE
+#define METRICS_SEND_FLAGS MSG_NOSIGNAL
+#endif
+
+#define METRICS_REQUEST_LENGTH 2048
+#define METRICS_INITIAL_RESPONSE_LENGTH 65536
+#define METRICS_LISTEN_BACKLOG 8
+// Scrapes are served one by one, so stalled client is dropped after this time
+#define METRICS_CLIENT_TIMEOUT_MS 5000
+
+// Growing text buffer of one response
+typedef struct
+{
+	char* data;
+	size_t length;
+	size_t capacity;
+} metricsBuffer;
+
+metricsSocket _metrics_socket = INVALID_SOCKET;
+pthread_t _metrics_thread;
+
+/**
+* Appends formatted text to buffer. Buffer is grown when text doesn't fit
+*
+* @param	buffer	response buffer
+* @param	format	printf format
+* @return	void
+*/
+void MetricsAppend(metricsBuffer* buffer, const char* format, ...)
+{
+	va_list args;
+	int length;
+
+	while (1)
+	{
+		va_start(args, format);
+		length = vsnprintf(buffer->data + buffer->length, buffer->capacity - buffer->length, format, args);
+		va_end(args);
+
+		if (length < 0)
+			return;
+		if ((size_t)length < buffer->capacity - buffer->length)
+		{
+			buffer->length += length;
+			return;
+		}
+
+		buffer->capacity = 2 * buffer->capacity + length;
+		buffer->data = realloc(buffer->data, buffer->capacity);
+	}
+}
+
+/**
+* Appends metric name with node label, followed by space before value. Backslash, double quote and
+* new line in node id are escaped, as exposition format requires
+*
+* @param	buffer			response buffer
+* @param	name			metric name
+* @param	node			node
+* @param	extraLabels		additional labels (eg. quantile="0.5") or NULL
+* @return	void
+*/
+void MetricsAppendNodeSample(metricsBuffer* buffer, const char* name, Node* node, const char* extraLabels)
+{
+	const char* c;
+
+	MetricsAppend(buffer, "%s{node=\"", name);
+	for (c = node->id; *c != '\0'; c++)
+	{
+		if (*c == '\\' || *c == '"')
+			MetricsAppend(buffer, "\\%c", *c);
+		else if (*c == '\n')
+			MetricsAppend(buffer, "\\n");
+		else
+			MetricsAppend(buffer, "%c", *c);
+	}
+	if (extraLabels != NULL)
+		MetricsAppend(buffer, "\",%s} ", extraLabels);
+	else
+		MetricsAppend(buffer, "\"} ");
+}
+
+/**
+* Appends metric family header
+*
+* @param	buffer	response buffer
+* @param	name	metric name
+* @param	type	metric type (counter, gauge, summary)
+* @param	help	metric description
+* @return	void
+*/
+void MetricsAppendHeader(metricsBuffer* buffer, const char* name, const char* type, const char* help)
+{
+	MetricsAppend(buffer, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+/**
+* Renders all metrics. Samples of the same metric are grouped together, so each family is rendered for all nodes at once.
+* Node statistics are merged once per scrape, before rendering
+*
+* @param	buffer	response buffer
+* @return	void
+*/
+void MetricsRender(metricsBuffer* buffer)
+{
+	int i, nodeThreadsCnt = 0;
+	int nodesCnt = COMMON_NODE_LIST_LENGTH;
+	nodeStats* stats = malloc((nodesCnt > 0 ? nodesCnt : 1) * sizeof(nodeStats));
+	eventBufferStats* bufferStats = malloc((nodesCnt > 0 ? nodesCnt : 1) * sizeof(eventBufferStats));
+
+	for (i = 0; i < nodesCnt; i++)
+	{
+		common_get_node_stats(COMMON_NODE_LIST[i], &stats[i]);
+		common_get_event_buffer_stats(COMMON_NODE_LIST[i], &bufferStats[i]);
+		if (COMMON_NODE_LIST[i]->isStarted)
+			nodeThreadsCnt++;
+	}
+
+	MetricsAppendHeader(buffer, "zen_engine_info", "gauge", "Engine version.");
+	MetricsAppend(buffer, "zen_engine_info{version=\"%s\"} 1\n", engineConfiguration.engineVersion);
+
+	MetricsAppendHeader(buffer, "zen_engine_nodes", "gauge", "Number of nodes in project.");
+	MetricsAppend(buffer, "zen_engine_nodes %d\n", nodesCnt);
+
+	// Thread per node mode creates node thread once, on first start of node
+	MetricsAppendHeader(buffer, "zen_engine_threads", "gauge", "Number of threads that execute nodes.");
+	if (engineConfiguration.executionMode == EXECUTION_MODE_WORKER_POOL)
+		MetricsAppend(buffer, "zen_engine_threads{kind=\"worker\"} %d\n", SchedulerGetWorkersCount());
+	else
+		MetricsAppend(buffer, "zen_engine_threads{kind=\"node\"} %d\n", nodeThreadsCnt);
+
+	MetricsAppendHeader(buffer, "zen_mqtt_publish_failures_total", "counter", "MQTT messages that engine failed to publish.");
+	MetricsAppend(buffer, "zen_mqtt_publish_failures_total %d\n", common_get_mqtt_publish_failures_cnt());
+
+	MetricsAppendHeader(buffer, "zen_node_fires_total", "counter", "Node executions.");
+	for (i = 0; i < nodesCnt; i++)
+	{
+		MetricsAppendNodeSample(buffer, "zen_node_fires_total", COMMON_NODE_LIST[i], NULL);
+		MetricsAppend(buffer, "%llu\n", (unsigned long long)stats[i].fireCnt);
+	}
+
+	MetricsAppendHeader(buffer, "zen_node_errors_total", "counter", "Node executions that ended with error.");
+	for (i = 0; i < nodesCnt; i++)
+	{
+		MetricsAppendNodeSample(buffer, "zen_node_errors_total", COMMON_NODE_LIST[i], NULL);
+		MetricsAppend(buffer, "%llu\n", (unsigned long long)stats[i].errorCnt);
+	}
+
+	MetricsAppendHeader(buffer, "zen_node_execution_seconds", "summary", "Node execution time.");
+	for (i = 0; i < nodesCnt; i++)
+	{
+		MetricsAppendNodeSample(buffer, "zen_node_execution_seconds", COMMON_NODE_LIST[i], "quantile=\"0.5\"");
+		MetricsAppend(buffer, "%.9f\n", stats[i].executionP50Ns / 1e9);
+		MetricsAppendNodeSample(buffer, "zen_node_execution_seconds", COMMON_NODE_LIST[i], "quantile=\"0.99\"");
+		MetricsAppend(buffer, "%.9f\n", stats[i].executionP99Ns / 1e9);
+		MetricsAppendNodeSample(buffer, "zen_node_execution_seconds", COMMON_NODE_LIST[i], "quantile=\"0.999\"");
+		MetricsAppend(buffer, "%.9f\n", stats[i].executionP999Ns / 1e9);
+		MetricsAppendNodeSample(buffer, "zen_node_execution_seconds_sum", COMMON_NODE_LIST[i], NULL);
+		MetricsAppend(buffer, "%.9f\n", stats[i].executionTotalNs / 1e9);
+		MetricsAppendNodeSample(buffer, "zen_node_execution_seconds_count", COMMON_NODE_LIST[i], NULL);
+		MetricsAppend(buffer, "%llu\n", (unsigned long long)stats[i].fireCnt);
+	}
+
+	MetricsAppendHeader(buffer, "zen_node_execution_max_seconds", "gauge", "Longest node execution time.");
+	for (i = 0; i < nodesCnt; i++)
+	{
+		MetricsAppendNodeSample(buffer, "zen_node_execution_max_seconds", COMMON_NODE_LIST[i], NULL);
+		MetricsAppend(buffer, "%.9f\n", stats[i].executionMaxNs / 1e9);
+	}
+
+	MetricsAppendHeader(buffer, "zen_node_queue_wait_seconds", "summary", "Time between node becoming ready and start of its execution.");
+	for (i = 0; i < nodesCnt; i++)
+	{
+		MetricsAppendNodeSample(buffer, "zen_node_queue_wait_seconds_sum", COMMON_NODE_LIST[i], NULL);
+		MetricsAppend(buffer, "%.9f\n", stats[i].queueWaitTotalNs / 1e9);
+		MetricsAppendNodeSample(buffer, "zen_node_queue_wait_seconds_count", COMMON_NODE_LIST[i], NULL);
+		MetricsAppend(buffer, "%llu\n", (unsigned long long)stats[i].queueWaitCnt);
+	}
+
+	// Event buffer metrics exist only for eventable nodes
+	MetricsAppendHeader(buffer, "zen_node_event_buffer_events", "gauge", "Events waiting in node event buffer.");
+	for (i = 0; i < nodesCnt; i++)
+	{
+		if (COMMON_NODE_LIST[i]->bufferedEvents == NULL)
+			continue;
+		MetricsAppendNodeSample(buffer, "zen_node_event_buffer_events", COMMON_NODE_LIST[i], NULL);
+		MetricsAppend(buffer, "%d\n", bufferStats[i].count);
+	}
+
+	MetricsAppendHeader(buffer, "zen_node_event_buffer_capacity", "gauge", "Maximum number of events in node event buffer.");
+	for (i = 0; i < nodesCnt; i++)
+	{
+		if (COMMON_NODE_LIST[i]->bufferedEvents == NULL)
+			continue;
+		MetricsAppendNodeSample(buffer, "zen_node_event_buffer_capacity", COMMON_NODE_LIST[i], NULL);
+		MetricsAppend(buffer, "%d\n", bufferStats[i].maxSize);
+	}
+
+	MetricsAppendHeader(buffer, "zen_node_event_buffer_high_water_mark", "gauge", "Most events ever buffered at once in node event buffer.");
+	for (i = 0; i < nodesCnt; i++)
+	{
+		if (COMMON_NODE_LIST[i]->bufferedEvents == NULL)
+			continue;
+		MetricsAppendNodeSample(buffer, "zen_node_event_buffer_high_water_mark", COMMON_NODE_LIST[i], NULL);
+		MetricsAppend(buffer, "%d\n", bufferStats[i].highWaterMark);
+	}
+
+	MetricsAppendHeader(buffer, "zen_node_event_buffer_dropped_total", "counter", "Events dropped by node event buffer overflow policy.");
+	for (i = 0; i < nodesCnt; i++)
+	{
+		if (COMMON_NODE_LIST[i]->bufferedEvents == NULL)
+			continue;
+		MetricsAppendNodeSample(buffer, "zen_node_event_buffer_dropped_total", COMMON_NODE_LIST[i], NULL);
+		MetricsAppend(buffer, "%d\n", bufferStats[i].droppedCnt);
+	}
+
+	free(stats);
+	free(bufferStats);
+}
+
+/**
+* Sends whole buffer to client
+*
+* @param	client	client socket
+* @param	data	data to send
+* @param	length	data length
+* @return	0 on success
+*/
+int MetricsSend(metricsSocket client, const char* data, size_t length)
+{
+	int sentCnt;
+
+	while (length > 0)
+	{
+		sentCnt = send(client, data, (int)length, METRICS_SEND_FLAGS);
+		if (sentCnt <= 0)
+			return 1;
+		data += sentCnt;
+		length -= sentCnt;
+	}
+	return 0;
+}
+
+/**
+* Sets receive and send timeout of client socket, so that client that stops sending or reading
+* doesn't block listener thread
+*
+* @param	client	client socket
+* @return	void
+*/
+void MetricsSetClientTimeout(metricsSocket client)
+{
+#if defined(_WIN32)
+	DWORD timeout = METRICS_CLIENT_TIMEOUT_MS;
+#else
+	struct timeval timeout;
+	timeout.tv_sec = METRICS_CLIENT_TIMEOUT_MS / 1000;
+	timeout.tv_usec = (METRICS_CLIENT_TIMEOUT_MS % 1000) * 1000;
+#endif
+
+	setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout));
+	setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, (const char*)&timeout, sizeof(timeout));
+}
+
+/**
+* Reads request and sends response. Only request line is used, so request is read until end of headers.
+* If client times out or fails, nothing is sent and caller closes connection
+*
+* @param	client	client socket
+* @return	void
+*/
+void MetricsServeClient(metricsSocket client)
+{
+	char request[METRICS_REQUEST_LENGTH];
+	char header[256];
+	int length = 0, readCnt;
+	metricsBuffer body;
+
+	while (length < (int)sizeof(request) - 1)
+	{
+		readCnt = recv(client, request + length, sizeof(request) - 1 - length, 0);
+		if (readCnt < 0)
+			return;
+		if (readCnt == 0)
+			break;
+		length += readCnt;
+		request[length] = '\0';
+		if (strstr(request, "\r\n\r\n") != NULL)
+			break;
+	}
+	request[length] = '\0';
+
+	if (strncmp(request, "GET /metrics ", strlen("GET /metrics ")) != 0 && strncmp(request, "GET / ", strlen("GET / ")) != 0)
+	{
+		const char* notFound = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+		MetricsSend(client, notFound, strlen(notFound));
+		return;
+	}
+
+	body.capacity = METRICS_INITIAL_RESPONSE_LENGTH;
+	body.length = 0;
+	body.data = malloc(body.capacity);
+	MetricsRender(&body);
+
+	snprintf(header, sizeof(header), "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %llu\r\nConnection: close\r\n\r\n",
+		(unsigned long long)body.length);
+	if (MetricsSend(client, header, strlen(header)) == 0)
+		MetricsSend(client, body.data, body.length);
+	free(body.data);
+}
+
+/**
+* Listener thread. Accepts scrapes until engine exits
+*
+* @param	params	not used
+* @return	NULL
+*/
+void* MetricsListen(void* params)
+{
+	metricsSocket client;
+
+	while (1)
+	{
+		client = accept(_metrics_socket, NULL, NULL);
+		if (client == INVALID_SOCKET)
+			continue;
+		MetricsSetClientTimeout(client);
+		MetricsServeClient(client);
+		CloseMetricsSocket(client);
+	}
+	return NULL;
+}
+
+/**
+* Opens listening socket and starts listener thread
+*
+* @param	address		listen address (eg. 127.0.0.1 or 0.0.0.0)
+* @param	port		listen port
+* @return	0 on success
+*/
+int MetricsStart(const char* address, int port)
+{
+	struct sockaddr_in socketAddress;
+	int reuse = 1;
+
+#if defined(_WIN32)
+	WSADATA wsaData;
+	if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0)
+	{
+		printf("Metrics : can't init sockets\n");
+		return 1;
+	}
+#endif
+
+	memset(&socketAddress, 0, sizeof(socketAddress));
+	socketAddress.sin_family = AF_INET;
+	socketAddress.sin_port = htons((unsigned short)port);
+	if (inet_pton(AF_INET, address, &socketAddress.sin_addr) != 1)
+	{
+		printf("Metrics : invalid address %s\n", address);
+		return 1;
+	}
+
+	_metrics_socket = socket(AF_INET, SOCK_STREAM, 0);
+	if (_metrics_socket == INVALID_SOCKET)
+	{
+		printf("Metrics : can't create socket\n");
+		return 1;
+	}
+	setsockopt(_metrics_socket, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+
+	if (bind(_metrics_socket, (struct sockaddr*)&socketAddress, sizeof(socketAddress)) != 0 || listen(_metrics_socket, METRICS_LISTEN_BACKLOG) != 0)
+	{
+		printf("Metrics : can't listen on %s:%d\n", address, port);
+		CloseMetricsSocket(_metrics_socket);
+		_metrics_socket = INVALID_SOCKET;
+		return 1;
+	}
+
+	pthread_create(&_metrics_thread, NULL, MetricsListen, NULL);
+	printf("Metrics available on http://%s:%d/metrics\n", address, port);
+	return 0;
+}
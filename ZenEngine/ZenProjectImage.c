@@ -0,0 +1,852 @@
+/*************************************************************************
+ * Copyright (c) 2015, 2018 Zenodys BV
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contributors:
+ *    Tomaž Vinko
+ *   
+ **************************************************************************/
+
+/*=======================================================================================
+|
+|       Binary project image
+|
+|		  * Compiled form of Implementations.zen, Modules.zen and Relations.zen : implementation
+|			table, node table, argument table, child relations in CSR form and interned strings.
+|		  * Engine maps image file and builds nodes directly from its tables, without JSON
+|			parsing and string splitting.
+|		  * Image is keyed by hash of .zen files. If they change (eg. remote update), image is
+|			stale and engine compiles it again from .zen files.
+|
++----------------------------------------------------------------------------------------
+|
+|   Known Bugs:		* none
+|
+|	     To Do:		* none
+*==========================================================================================*/
+#include "ZenProjectImage.h"
+#include "ZenCommon.h"
+#include "cJSON.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define FNV64_OFFSET_BASIS 14695981039346656037ULL
+#define FNV64_PRIME 1099511628211ULL
+
+// Relation between parent and child node, in order of Relations.zen
+typedef struct
+{
+	uint32_t parent;
+	uint32_t child;
+	int isTrueChild;
+} imageRelation;
+
+// Image tables, while image is compiled
+typedef struct
+{
+	projectImageImplementation* implementations;
+	uint32_t implementationsCnt;
+	uint32_t implementationsCapacity;
+	projectImageNode* nodes;
+	uint32_t nodesCnt;
+	uint32_t nodesCapacity;
+	projectImageArg* args;
+	uint32_t argsCnt;
+	uint32_t argsCapacity;
+	imageRelation* relations;
+	uint32_t relationsCnt;
+	uint32_t relationsCapacity;
+	char* strings;
+	uint32_t stringsSize;
+	uint32_t stringsCapacity;
+	// Open addressing index of interned strings. Slot holds string offset + 1, zero is empty slot
+	uint32_t* stringIndex;
+	uint32_t stringIndexMask;
+	uint32_t stringsCnt;
+	// Open addressing index of node ids. Slot holds node index + 1, zero is empty slot
+	uint32_t* nodeIndex;
+	uint32_t nodeIndexMask;
+} imageBuilder;
+
+//************************************************************************/
+//************************ START HELPERS *********************************/
+//************************************************************************/
+
+/**
+* Continues FNV-1a 64 bit hash over bytes
+*
+* @param	hash	hash so far
+* @param	data	bytes to hash
+* @param	length	number of bytes
+* @return	hash
+*/
+uint64_t HashImageBytes(uint64_t hash, const void* data, size_t length)
+{
+	const unsigned char* bytes = data;
+	size_t i;
+	for (i = 0; i < length; i++)
+	{
+		hash ^= bytes[i];
+		hash *= FNV64_PRIME;
+	}
+	return hash;
+}
+
+/**
+* Hashes contents of project .zen files. Image version is part of hash too
+*
+* @param	inputs		contents of .zen files
+* @param	inputsCnt	number of files
+* @return	hash
+*/
+uint64_t HashProjectInputs(char** inputs, int inputsCnt)
+{
+	uint32_t version = PROJECT_IMAGE_VERSION;
+	uint64_t hash = HashImageBytes(FNV64_OFFSET_BASIS, &version, sizeof(version));
+	int i;
+
+	// Terminating zeros separate files, so content can't move from one file to another with the same hash
+	for (i = 0; i < inputsCnt; i++)
+		hash = HashImageBytes(hash, inputs[i], strlen(inputs[i]) + 1);
+	return hash;
+}
+
+/**
+* Makes room for one more item in growable table
+*
+* @param	items		table items
+* @param	cnt			number of items
+* @param	capacity	allocated number of items
+* @param	itemSize	size of item
+* @return	new item
+*/
+void* AppendImageItem(void** items, uint32_t* cnt, uint32_t* capacity, size_t itemSize)
+{
+	if (*cnt == *capacity)
+	{
+		*capacity = *capacity > 0 ? *capacity * 2 : 16;
+		*items = realloc(*items, *capacity * itemSize);
+	}
+	return (char*)*items + (*cnt)++ * itemSize;
+}
+
+/**
+* Doubles string index and rehashes interned strings
+*
+* @param	builder		image under construction
+* @return	void
+*/
+void GrowImageStringIndex(imageBuilder* builder)
+{
+	uint32_t i, slot, newMask = builder->stringIndexMask > 0 ? builder->stringIndexMask * 2 + 1 : 255;
+	uint32_t* newIndex = calloc(newMask + 1, sizeof(uint32_t));
+	const char* str;
+
+	for (i = 0; builder->stringIndexMask > 0 && i <= builder->stringIndexMask; i++)
+	{
+		if (builder->stringIndex[i] == 0)
+			continue;
+
+		str = builder->strings + builder->stringIndex[i] - 1;
+		slot = (uint32_t)HashImageBytes(FNV64_OFFSET_BASIS, str, strlen(str)) & newMask;
+		while (newIndex[slot] != 0)
+			slot = (slot + 1) & newMask;
+		newIndex[slot] = builder->stringIndex[i];
+	}
+	free(builder->stringIndex);
+	builder->stringIndex = newIndex;
+	builder->stringIndexMask = newMask;
+}
+
+/**
+* Adds string to string table. Each distinct string is stored only once
+*
+* @param	builder		image under construction
+* @param	str			string
+* @param	length		string length
+* @return	offset of string in string table
+*/
+uint32_t InternImageString(imageBuilder* builder, const char* str, size_t length)
+{
+	uint32_t slot, offset;
+
+	// Index is kept at most half full
+	if ((builder->stringsCnt + 1) * 2 > builder->stringIndexMask)
+		GrowImageStringIndex(builder);
+
+	slot = (uint32_t)HashImageBytes(FNV64_OFFSET_BASIS, str, length) & builder->stringIndexMask;
+	while (builder->stringIndex[slot] != 0)
+	{
+		offset = builder->stringIndex[slot] - 1;
+		if (strncmp(builder->strings + offset, str, length) == 0 && builder->strings[offset + length] == '\0')
+			return offset;
+		slot = (slot + 1) & builder->stringIndexMask;
+	}
+
+	while (builder->stringsSize + length + 1 > builder->stringsCapacity)
+	{
+		builder->stringsCapacity = builder->stringsCapacity > 0 ? builder->stringsCapacity * 2 : 4096;
+		builder->strings = realloc(builder->strings, builder->stringsCapacity);
+	}
+	offset = builder->stringsSize;
+	memcpy(builder->strings + offset, str, length);
+	builder->strings[offset + length] = '\0';
+	builder->stringsSize += (uint32_t)length + 1;
+
+	builder->stringIndex[slot] = offset + 1;
+	builder->stringsCnt++;
+	return offset;
+}
+
+/**
+* Adds first word of token to string table. Leading and trailing whitespaces are skipped, same as with sscanf %s
+*
+* @param	builder		image under construction
+* @param	token		token from .zen file
+* @return	offset of word in string table
+*/
+uint32_t InternImageWord(imageBuilder* builder, const char* token)
+{
+	size_t length = 0;
+	while (isspace((unsigned char)*token))
+		token++;
+	while (token[length] != '\0' && !isspace((unsigned char)token[length]))
+		length++;
+	return InternImageString(builder, token, length);
+}
+
+/**
+* Finds node by id among already compiled nodes
+*
+* @param	builder		image under construction
+* @param	id			node id
+* @return	node index, or -1 if node doesn't exist
+*/
+int FindImageNode(imageBuilder* builder, const char* id)
+{
+	uint32_t slot = (uint32_t)HashImageBytes(FNV64_OFFSET_BASIS, id, strlen(id)) & builder->nodeIndexMask;
+	while (builder->nodeIndex[slot] != 0)
+	{
+		if (strcmp(builder->strings + builder->nodes[builder->nodeIndex[slot] - 1].id, id) == 0)
+			return builder->nodeIndex[slot] - 1;
+		slot = (slot + 1) & builder->nodeIndexMask;
+	}
+	return -1;
+}
+
+/**
+* Builds index of node ids. If ids are duplicated, first node wins, same as in engine's node index
+*
+* @param	builder		image under construction
+* @return	void
+*/
+void BuildImageNodeIndex(imageBuilder* builder)
+{
+	uint32_t i, slot, indexSize = 16;
+	const char* id;
+
+	while (indexSize < builder->nodesCnt * 2)
+		indexSize <<= 1;
+	builder->nodeIndex = calloc(indexSize, sizeof(uint32_t));
+	builder->nodeIndexMask = indexSize - 1;
+
+	for (i = 0; i < builder->nodesCnt; i++)
+	{
+		id = builder->strings + builder->nodes[i].id;
+		if (FindImageNode(builder, id) >= 0)
+			continue;
+
+		slot = (uint32_t)HashImageBytes(FNV64_OFFSET_BASIS, id, strlen(id)) & builder->nodeIndexMask;
+		while (builder->nodeIndex[slot] != 0)
+			slot = (slot + 1) & builder->nodeIndexMask;
+		builder->nodeIndex[slot] = i + 1;
+	}
+}
+
+/**
+* Sets image tables from image memory
+*
+* @param	image	image
+* @param	base	start of image
+* @return	void
+*/
+void SetImageTables(projectImage* image, const char* base)
+{
+	image->header = (const projectImageHeader*)base;
+	image->implementations = (const projectImageImplementation*)(base + image->header->implementationsOffset);
+	image->nodes = (const projectImageNode*)(base + image->header->nodesOffset);
+	image->args = (const projectImageArg*)(base + image->header->argsOffset);
+	image->trueChildRows = (const uint32_t*)(base + image->header->trueChildRowsOffset);
+	image->trueChilds = (const uint32_t*)(base + image->header->trueChildsOffset);
+	image->falseChildRows = (const uint32_t*)(base + image->header->falseChildRowsOffset);
+	image->falseChilds = (const uint32_t*)(base + image->header->falseChildsOffset);
+	image->strings = base + image->header->stringsOffset;
+}
+
+/**
+* Gets string from image string table
+*
+* @param	image	image
+* @param	offset	string offset
+* @return	string
+*/
+const char* GetImageString(const projectImage* image, uint32_t offset)
+{
+	return image->strings + offset;
+}
+
+//************************************************************************/
+//************************ END HELPERS ***********************************/
+//************************************************************************/
+
+//************************************************************************/
+//************************ START COMPILING *******************************/
+//************************************************************************/
+
+/**
+* Compiles Implementations.zen : fileName,id,type,params;...
+*
+* @param	builder		image under construction
+* @param	input		content of Implementations.zen
+* @return	0 on success
+*/
+int CompileImplementations(imageBuilder* builder, const char* input)
+{
+	int i, numImplementations = 0, numTokens;
+	char **implementations = NULL, **tokens;
+	projectImageImplementation* implementation;
+
+	common_str_split(input, ";", &numImplementations, &implementations);
+	for (i = 0; i < numImplementations; i++)
+	{
+		if (strcmp(implementations[i], "") == 0)
+			break;
+
+		numTokens = 0;
+		tokens = NULL;
+		common_str_split(implementations[i], ",", &numTokens, &tokens);
+		if (numTokens < 4)
+		{
+			fprintf(stderr, "Invalid implementation %s...\n", implementations[i]);
+			common_free_splitted_string(tokens, numTokens);
+			common_free_splitted_string(implementations, numImplementations);
+			return 1;
+		}
+
+		implementation = AppendImageItem((void**)&builder->implementations, &builder->implementationsCnt, &builder->implementationsCapacity, sizeof(projectImageImplementation));
+		implementation->fileName = InternImageWord(builder, tokens[0]);
+		implementation->id = InternImageWord(builder, tokens[1]);
+		implementation->params = InternImageWord(builder, tokens[3]);
+		common_free_splitted_string(tokens, numTokens);
+	}
+	common_free_splitted_string(implementations, numImplementations);
+	return 0;
+}
+
+/**
+* Compiles Modules.zen : JSON object with ELEMENT_NAME, IMPLEMENTATION, OPERATOR and ELEMENT_PROPERTIES of each node
+*
+* @param	builder		image under construction
+* @param	input		content of Modules.zen
+* @return	0 on success
+*/
+int CompileNodes(imageBuilder* builder, const char* input)
+{
+	int i, nodesCount;
+	cJSON *root, *subitem, *name, *implementationId, *nodeOperator, *properties, *property;
+	projectImageNode* node;
+	projectImageArg* arg;
+
+	root = cJSON_Parse(input);
+	if (root == NULL)
+	{
+		fprintf(stderr, "Cannot parse Modules.zen...\n");
+		return 1;
+	}
+
+	nodesCount = cJSON_GetArraySize(root);
+	for (i = 0; i < nodesCount; i++)
+	{
+		subitem = cJSON_GetArrayItem(root, i);
+		name = cJSON_GetObjectItem(subitem, "ELEMENT_NAME");
+		implementationId = cJSON_GetObjectItem(subitem, "IMPLEMENTATION");
+		nodeOperator = cJSON_GetObjectItem(subitem, "OPERATOR");
+		properties = cJSON_GetObjectItem(subitem, "ELEMENT_PROPERTIES");
+		// Only "&" and "||" operators are valid, anything else would silently change workflow semantics
+		if (name == NULL || name->valuestring == NULL || implementationId == NULL || implementationId->valuestring == NULL ||
+			nodeOperator == NULL || nodeOperator->valuestring == NULL || properties == NULL ||
+			(strcmp(nodeOperator->valuestring, "&") != 0 && strcmp(nodeOperator->valuestring, "||") != 0))
+		{
+			fprintf(stderr, "Invalid node %s in Modules.zen...\n", subitem->string != NULL ? subitem->string : "");
+			cJSON_Delete(root);
+			return 1;
+		}
+
+		node = AppendImageItem((void**)&builder->nodes, &builder->nodesCnt, &builder->nodesCapacity, sizeof(projectImageNode));
+		node->id = InternImageString(builder, name->valuestring, strlen(name->valuestring));
+		node->implementationId = InternImageString(builder, implementationId->valuestring, strlen(implementationId->valuestring));
+		node->nodeOperator = strcmp(nodeOperator->valuestring, "||") == 0 ? NODE_OPERATOR_OR : NODE_OPERATOR_AND;
+		node->firstArg = builder->argsCnt;
+		node->argsCnt = 0;
+
+		for (property = properties->child; property != NULL; property = property->next)
+		{
+			arg = AppendImageItem((void**)&builder->args, &builder->argsCnt, &builder->argsCapacity, sizeof(projectImageArg));
+			arg->key = InternImageString(builder, property->string, strlen(property->string));
+			arg->value = property->valuestring != NULL ? InternImageString(builder, property->valuestring, strlen(property->valuestring)) : InternImageString(builder, "", 0);
+			node->argsCnt++;
+		}
+	}
+	cJSON_Delete(root);
+	BuildImageNodeIndex(builder);
+	return 0;
+}
+
+/**
+* Adds childs from relation field (child names separated by |) to relation list
+*
+* @param	builder		image under construction
+* @param	parent		parent node index
+* @param	field		child names
+* @param	isTrueChild	1 for true childs, 0 for false childs
+* @return	void
+*/
+void CompileChilds(imageBuilder* builder, uint32_t parent, const char* field, int isTrueChild)
+{
+	int i, child, numChilds = 0;
+	char **childs = NULL;
+	uint32_t word;
+	imageRelation* relation;
+
+	word = InternImageWord(builder, field);
+	common_str_split(builder->strings + word, "|", &numChilds, &childs);
+	for (i = 0; i < numChilds; i++)
+	{
+		if (strcmp(childs[i], "") == 0)
+			continue;
+
+		child = FindImageNode(builder, childs[i]);
+		if (child < 0)
+		{
+			fprintf(stderr, "Unknown child %s of %s in Relations.zen...\n", childs[i], builder->strings + builder->nodes[parent].id);
+			continue;
+		}
+
+		relation = AppendImageItem((void**)&builder->relations, &builder->relationsCnt, &builder->relationsCapacity, sizeof(imageRelation));
+		relation->parent = parent;
+		relation->child = child;
+		relation->isTrueChild = isTrueChild;
+	}
+	common_free_splitted_string(childs, numChilds);
+}
+
+/**
+* Compiles Relations.zen : id,true_child_1|true_child_2,false_child_1;...
+*
+* @param	builder		image under construction
+* @param	input		content of Relations.zen
+* @return	0 on success
+*/
+int CompileRelations(imageBuilder* builder, const char* input)
+{
+	int i, parent, numRelations = 0, numRelation;
+	char **relations = NULL, **relation;
+
+	common_str_split(input, ";", &numRelations, &relations);
+	for (i = 0; i < numRelations; i++)
+	{
+		numRelation = 0;
+		relation = NULL;
+		common_str_split(relations[i], ",", &numRelation, &relation);
+		if (strcmp(*relation, "") == 0)
+		{
+			common_free_splitted_string(relation, numRelation);
+			break;
+		}
+
+		parent = FindImageNode(builder, builder->strings + InternImageWord(builder, relation[0]));
+		if (parent >= 0)
+		{
+			if (numRelation > 1)
+				CompileChilds(builder, parent, relation[1], 1);
+			if (numRelation > 2)
+				CompileChilds(builder, parent, relation[2], 0);
+		}
+		common_free_splitted_string(relation, numRelation);
+	}
+	common_free_splitted_string(relations, numRelations);
+	return 0;
+}
+
+/**
+* Fills CSR table of true or false childs. Childs keep order from Relations.zen
+*
+* @param	builder		image under construction
+* @param	isTrueChild	1 for true childs, 0 for false childs
+* @param	rows		row offsets, nodesCnt + 1 items (output argument)
+* @param	childs		child node indices (output argument)
+* @return	void
+*/
+void FillImageChilds(imageBuilder* builder, int isTrueChild, uint32_t* rows, uint32_t* childs)
+{
+	uint32_t i;
+
+	memset(rows, 0, (builder->nodesCnt + 1) * sizeof(uint32_t));
+	for (i = 0; i < builder->relationsCnt; i++)
+		if (builder->relations[i].isTrueChild == isTrueChild)
+			rows[builder->relations[i].parent + 1]++;
+
+	for (i = 0; i < builder->nodesCnt; i++)
+		rows[i + 1] += rows[i];
+
+	// Rows are used as insert positions, shifted back at the end
+	for (i = 0; i < builder->relationsCnt; i++)
+		if (builder->relations[i].isTrueChild == isTrueChild)
+			childs[rows[builder->relations[i].parent]++] = builder->relations[i].child;
+
+	for (i = builder->nodesCnt; i > 0; i--)
+		rows[i] = rows[i - 1];
+	rows[0] = 0;
+}
+
+/**
+* Lays out compiled tables into single image buffer
+*
+* @param	builder		compiled tables
+* @param	inputsHash	hash of .zen files
+* @param	image		image (output argument)
+* @return	void
+*/
+void WriteImage(imageBuilder* builder, uint64_t inputsHash, projectImage* image)
+{
+	projectImageHeader header;
+	uint32_t i, trueChildsCnt = 0, falseChildsCnt = 0;
+	char* buffer;
+
+	for (i = 0; i < builder->relationsCnt; i++)
+	{
+		if (builder->relations[i].isTrueChild)
+			trueChildsCnt++;
+		else
+			falseChildsCnt++;
+	}
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, PROJECT_IMAGE_MAGIC, sizeof(header.magic));
+	header.version = PROJECT_IMAGE_VERSION;
+	header.inputsHash = inputsHash;
+	header.implementationsCnt = builder->implementationsCnt;
+	header.nodesCnt = builder->nodesCnt;
+	header.argsCnt = builder->argsCnt;
+	header.trueChildsCnt = trueChildsCnt;
+	header.falseChildsCnt = falseChildsCnt;
+	header.stringsSize = builder->stringsSize;
+
+	// All tables hold 32 bit values, so they stay aligned
+	header.implementationsOffset = sizeof(projectImageHeader);
+	header.nodesOffset = header.implementationsOffset + builder->implementationsCnt * sizeof(projectImageImplementation);
+	header.argsOffset = header.nodesOffset + builder->nodesCnt * sizeof(projectImageNode);
+	header.trueChildRowsOffset = header.argsOffset + builder->argsCnt * sizeof(projectImageArg);
+	header.trueChildsOffset = header.trueChildRowsOffset + (builder->nodesCnt + 1) * sizeof(uint32_t);
+	header.falseChildRowsOffset = header.trueChildsOffset + trueChildsCnt * sizeof(uint32_t);
+	header.falseChildsOffset = header.falseChildRowsOffset + (builder->nodesCnt + 1) * sizeof(uint32_t);
+	header.stringsOffset = header.falseChildsOffset + falseChildsCnt * sizeof(uint32_t);
+	header.imageSize = header.stringsOffset + builder->stringsSize;
+
+	buffer = common_project_arena_alloc(header.imageSize);
+	memcpy(buffer, &header, sizeof(header));
+	if (builder->implementationsCnt > 0)
+		memcpy(buffer + header.implementationsOffset, builder->implementations, builder->implementationsCnt * sizeof(projectImageImplementation));
+	if (builder->nodesCnt > 0)
+		memcpy(buffer + header.nodesOffset, builder->nodes, builder->nodesCnt * sizeof(projectImageNode));
+	if (builder->argsCnt > 0)
+		memcpy(buffer + header.argsOffset, builder->args, builder->argsCnt * sizeof(projectImageArg));
+	FillImageChilds(builder, 1, (uint32_t*)(buffer + header.trueChildRowsOffset), (uint32_t*)(buffer + header.trueChildsOffset));
+	FillImageChilds(builder, 0, (uint32_t*)(buffer + header.falseChildRowsOffset), (uint32_t*)(buffer + header.falseChildsOffset));
+	if (builder->stringsSize > 0)
+		memcpy(buffer + header.stringsOffset, builder->strings, builder->stringsSize);
+
+	image->buffer = buffer;
+	SetImageTables(image, buffer);
+}
+
+/**
+* Compiles project .zen files into image in memory
+*
+* @param	implementationsInput	content of Implementations.zen
+* @param	nodesInput				content of Modules.zen
+* @param	relationsInput			content of Relations.zen
+* @param	inputsHash				hash of .zen files (HashProjectInputs)
+* @param	image					compiled image (output argument)
+* @return	0 on success
+*/
+int CompileProjectImage(const char* implementationsInput, const char* nodesInput, const char* relationsInput, uint64_t inputsHash, projectImage* image)
+{
+	imageBuilder builder;
+	int rc;
+
+	memset(&builder, 0, sizeof(builder));
+	rc = CompileImplementations(&builder, implementationsInput);
+	if (rc == 0)
+		rc = CompileNodes(&builder, nodesInput);
+	if (rc == 0)
+		rc = CompileRelations(&builder, relationsInput);
+	if (rc == 0)
+		WriteImage(&builder, inputsHash, image);
+
+	free(builder.implementations);
+	free(builder.nodes);
+	free(builder.args);
+	free(builder.relations);
+	free(builder.strings);
+	free(builder.stringIndex);
+	free(builder.nodeIndex);
+	return rc;
+}
+
+/**
+* Saves compiled image. Image is written to temporary file first and then renamed,
+* so that interrupted write never leaves half written image
+*
+* @param	image		compiled image
+* @param	imageFile	image file name
+* @return	0 on success
+*/
+int SaveProjectImage(const projectImage* image, const char* imageFile)
+{
+	char tmpFile[MAX_PATH];
+	FILE* fp;
+	size_t written;
+
+	snprintf(tmpFile, sizeof(tmpFile), "%s%s", imageFile, ".tmp");
+	fp = fopen(tmpFile, "wb");
+	if (!fp)
+		return 1;
+
+	written = fwrite(image->header, 1, image->header->imageSize, fp);
+	if (fclose(fp) != 0 || written != image->header->imageSize)
+	{
+		remove(tmpFile);
+		return 1;
+	}
+
+	// Windows rename doesn't replace existing file
+	remove(imageFile);
+	return rename(tmpFile, imageFile) == 0 ? 0 : 1;
+}
+
+//************************************************************************/
+//************************ END COMPILING *********************************/
+//************************************************************************/
+
+//************************************************************************/
+//************************ START MAPPING *********************************/
+//************************************************************************/
+
+/**
+* Checks that table starts where previous one ends, as WriteImage lays them out
+*
+* @param	tableOffset		offset of table from header
+* @param	offset			end of previous table, moved to end of this one
+* @param	cnt				number of table elements
+* @param	elementSize		size of table element
+* @return	1 if table is in place, otherwise 0
+*/
+int IsImageTableValid(uint32_t tableOffset, uint64_t* offset, uint32_t cnt, size_t elementSize)
+{
+	if (tableOffset != *offset)
+		return 0;
+	*offset += (uint64_t)cnt * elementSize;
+	return 1;
+}
+
+/**
+* Checks child relations in CSR form : rows must be monotonic and end at childs count,
+* childs must be indices of existing nodes
+*
+* @param	nodesCnt	number of nodes
+* @param	rows		childs rows (nodesCnt + 1 entries)
+* @param	childs		childs
+* @param	childsCnt	number of childs
+* @return	1 if relations are valid, otherwise 0
+*/
+int AreImageChildsValid(uint32_t nodesCnt, const uint32_t* rows, const uint32_t* childs, uint32_t childsCnt)
+{
+	uint32_t i;
+
+	if (rows[0] != 0 || rows[nodesCnt] != childsCnt)
+		return 0;
+	for (i = 0; i < nodesCnt; i++)
+	{
+		if (rows[i] > rows[i + 1])
+			return 0;
+	}
+	for (i = 0; i < childsCnt; i++)
+	{
+		if (childs[i] >= nodesCnt)
+			return 0;
+	}
+	return 1;
+}
+
+/**
+* Checks that image belongs to current .zen files and that everything engine reads from it is inside image :
+* tables, relations, argument ranges and string offsets. Image that fails any check is compiled again
+*
+* @param	header		image header
+* @param	size		size of image file
+* @param	inputsHash	hash of .zen files
+* @return	1 if image can be used, otherwise 0
+*/
+int IsImageValid(const projectImageHeader* header, size_t size, uint64_t inputsHash)
+{
+	projectImage image;
+	uint64_t offset = sizeof(projectImageHeader);
+	uint32_t i, stringsSize;
+
+	if (size < sizeof(projectImageHeader) || memcmp(header->magic, PROJECT_IMAGE_MAGIC, sizeof(header->magic)) != 0)
+		return 0;
+	if (header->version != PROJECT_IMAGE_VERSION || header->inputsHash != inputsHash || header->imageSize != size)
+		return 0;
+
+	if (!IsImageTableValid(header->implementationsOffset, &offset, header->implementationsCnt, sizeof(projectImageImplementation))
+		|| !IsImageTableValid(header->nodesOffset, &offset, header->nodesCnt, sizeof(projectImageNode))
+		|| !IsImageTableValid(header->argsOffset, &offset, header->argsCnt, sizeof(projectImageArg))
+		|| !IsImageTableValid(header->trueChildRowsOffset, &offset, header->nodesCnt + 1, sizeof(uint32_t))
+		|| !IsImageTableValid(header->trueChildsOffset, &offset, header->trueChildsCnt, sizeof(uint32_t))
+		|| !IsImageTableValid(header->falseChildRowsOffset, &offset, header->nodesCnt + 1, sizeof(uint32_t))
+		|| !IsImageTableValid(header->falseChildsOffset, &offset, header->falseChildsCnt, sizeof(uint32_t))
+		|| !IsImageTableValid(header->stringsOffset, &offset, header->stringsSize, 1)
+		|| offset != size)
+		return 0;
+
+	// Every string ends before end of table, if table ends with terminator
+	stringsSize = header->stringsSize;
+	if (stringsSize > 0 && ((const char*)header)[size - 1] != '\0')
+		return 0;
+
+	SetImageTables(&image, (const char*)header);
+	if (!AreImageChildsValid(header->nodesCnt, image.trueChildRows, image.trueChilds, header->trueChildsCnt)
+		|| !AreImageChildsValid(header->nodesCnt, image.falseChildRows, image.falseChilds, header->falseChildsCnt))
+		return 0;
+
+	for (i = 0; i < header->implementationsCnt; i++)
+	{
+		if (image.implementations[i].fileName >= stringsSize || image.implementations[i].id >= stringsSize || image.implementations[i].params >= stringsSize)
+			return 0;
+	}
+	for (i = 0; i < header->nodesCnt; i++)
+	{
+		if (image.nodes[i].id >= stringsSize || image.nodes[i].implementationId >= stringsSize || image.nodes[i].nodeOperator > NODE_OPERATOR_OR)
+			return 0;
+		if ((uint64_t)image.nodes[i].firstArg + image.nodes[i].argsCnt > header->argsCnt)
+			return 0;
+	}
+	for (i = 0; i < header->argsCnt; i++)
+	{
+		if (image.args[i].key >= stringsSize || image.args[i].value >= stringsSize)
+			return 0;
+	}
+	return 1;
+}
+
+/**
+* Maps image file into memory. Image is used directly from mapped memory and stays mapped while engine runs
+*
+* @param	imageFile	image file name
+* @param	inputsHash	hash of current .zen files
+* @param	image		mapped image (output argument)
+* @return	0 on success, otherwise image is missing, stale or invalid
+*/
+int MapProjectImage(const char* imageFile, uint64_t inputsHash, projectImage* image)
+{
+	const char* base;
+	size_t size;
+
+#if defined(_WIN32)
+	HANDLE file, mapping;
+	LARGE_INTEGER fileSize;
+
+	file = CreateFileA(imageFile, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return 1;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < (LONGLONG)sizeof(projectImageHeader))
+	{
+		CloseHandle(file);
+		return 1;
+	}
+	size = (size_t)fileSize.QuadPart;
+
+	mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if (mapping == NULL)
+		return 1;
+
+	// View keeps mapping alive after handle is closed
+	base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (base == NULL)
+		return 1;
+
+	if (!IsImageValid((const projectImageHeader*)base, size, inputsHash))
+	{
+		UnmapViewOfFile(base);
+		return 1;
+	}
+#else
+	int fd;
+	struct stat st;
+
+	fd = open(imageFile, O_RDONLY);
+	if (fd < 0)
+		return 1;
+	if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(projectImageHeader))
+	{
+		close(fd);
+		return 1;
+	}
+	size = (size_t)st.st_size;
+
+	base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED)
+		return 1;
+
+	if (!IsImageValid((const projectImageHeader*)base, size, inputsHash))
+	{
+		munmap((void*)base, size);
+		return 1;
+	}
+#endif
+
+	image->buffer = NULL;
+	SetImageTables(image, base);
+	return 0;
+}
+
+//************************************************************************/
+//************************ END MAPPING ***********************************/
+//************************************************************************/
@@ -0,0 +1,101 @@
+/*************************************************************************
+ * Copyright (c) 2015, 2018 Zenodys BV
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contributors:
+ *    Tomaž Vinko
+ *   
+ **************************************************************************/
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+#define PROJECT_IMAGE_MAGIC "ZIMG"
+#define PROJECT_IMAGE_VERSION 1
+
+// Image file name, under project's DB folder
+#define PROJECT_IMAGE_FILE_NAME "Project.zimg"
+
+/* Image header. All offsets are in bytes from the start of image, all strings are offsets in string table.
+* Image is written in native byte order, as it's compiled on the same device that loads it
+*/
+typedef struct
+{
+	char magic[4];
+	uint32_t version;
+	// FNV-1a hash of Implementations.zen, Modules.zen and Relations.zen. Image is stale if it doesn't match
+	uint64_t inputsHash;
+	uint32_t imageSize;
+	uint32_t implementationsCnt;
+	uint32_t nodesCnt;
+	uint32_t argsCnt;
+	uint32_t trueChildsCnt;
+	uint32_t falseChildsCnt;
+	uint32_t stringsSize;
+	uint32_t implementationsOffset;
+	uint32_t nodesOffset;
+	uint32_t argsOffset;
+	// Childs are in CSR form : childs of node i are childs[rows[i]] .. childs[rows[i + 1] - 1]
+	uint32_t trueChildRowsOffset;
+	uint32_t trueChildsOffset;
+	uint32_t falseChildRowsOffset;
+	uint32_t falseChildsOffset;
+	uint32_t stringsOffset;
+} projectImageHeader;
+
+typedef struct
+{
+	uint32_t fileName;
+	uint32_t id;
+	uint32_t params;
+} projectImageImplementation;
+
+typedef struct
+{
+	uint32_t id;
+	uint32_t implementationId;
+	uint32_t nodeOperator;
+	// Node's arguments are args[firstArg] .. args[firstArg + argsCnt - 1]
+	uint32_t firstArg;
+	uint32_t argsCnt;
+} projectImageNode;
+
+typedef struct
+{
+	uint32_t key;
+	uint32_t value;
+} projectImageArg;
+
+// Loaded image. Tables point directly into mapped file (or memory buffer, if image was just compiled)
+typedef struct
+{
+	const projectImageHeader* header;
+	const projectImageImplementation* implementations;
+	const projectImageNode* nodes;
+	const projectImageArg* args;
+	const uint32_t* trueChildRows;
+	const uint32_t* trueChilds;
+	const uint32_t* falseChildRows;
+	const uint32_t* falseChilds;
+	const char* strings;
+	// Compiled image buffer in project arena, or NULL if image is mapped from file
+	char* buffer;
+} projectImage;
+
+uint64_t HashProjectInputs(char** inputs, int inputsCnt);
+int CompileProjectImage(const char* implementationsInput, const char* nodesInput, const char* relationsInput, uint64_t inputsHash, projectImage* image);
+int SaveProjectImage(const projectImage* image, const char* imageFile);
+int MapProjectImage(const char* imageFile, uint64_t inputsHash, projectImage* image);
+const char* GetImageString(const projectImage* image, uint32_t offset);
@@ -0,0 +1,360 @@
+/*************************************************************************
+ * Copyright (c) 2015, 2018 Zenodys BV
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Contributors:
+ *    Tomaž Vinko
+ *   
+ **************************************************************************/
+
+/*=======================================================================================
+|
+|       Worker pool execution mode
+|
+|		  * Instead of thread per node, fixed number of workers (by default one per core)
+|			executes nodes that are ready to run.
+|		  * Each loop has its own queue (strand) of ready nodes. Only one worker at a time
+|			owns loop strand, so nodes from same loop are executed one by one in the order
+|			they became ready, same as with _loop_locks in thread per node mode.
+|		  * Each worker has its own deque of strands with ready nodes. Worker keeps executing
+|			the same loop while it has ready nodes (children of finished node are pushed to
+|			the same strand, so they run on the same core). Other loops in worker's deque can
+|			be stolen by idle workers, so independent loops are balanced across cores.
+|
++----------------------------------------------------------------------------------------
+|
+|   Known Bugs:		* Elements that block (eg. Sleep) keep worker busy, so loops with
+|					  such Elements need enough workers
+|
+|	     To Do:		* none
+*==========================================================================================*/
+#include "ZenScheduler.h"
+#include "ZenEngine.h"
+#include "pthread.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#define THREAD_LOCAL __declspec(thread)
+#else
+#include <unistd.h>
+#define THREAD_LOCAL __thread
+#endif
+
+// Max number of nodes worker executes from the same loop, before it gives other loops a chance
+#define STRAND_BUDGET 64
+
+// Queue of ready nodes that belong to the same loop
+struct loopStrand {
+	pthread_mutex_t lock;
+	Node* head;
+	Node* tail;
+	int isScheduled;
+};
+
+// Worker's strands. Owner pushes and pops at bottom, thieves steal from top
+struct workerDeque {
+	pthread_mutex_t lock;
+	struct loopStrand** strands;
+	int top;
+	int bottom;
+};
+
+struct loopStrand* _strands;
+int _strands_cnt = 0;
+
+struct workerDeque* _deques;
+pthread_t* _worker_threads;
+int _workers_cnt = 0;
+
+// Idle workers are sleeping on this condition
+pthread_mutex_t _idle_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t _idle_cond;
+int _idle_workers_cnt = 0;
+
+// Index of worker that owns current thread, -1 for non worker threads
+THREAD_LOCAL int _worker_id = -1;
+
+// Deque, where strands scheduled from non worker threads go next
+int _next_deque = 0;
+
+/**
+* Pushes strand to the bottom (owner side) of worker deque
+*
+* @param	deque	worker deque
+* @param	strand	strand with ready nodes
+* @return	void
+*/
+void DequePushBottom(struct workerDeque* deque, struct loopStrand* strand)
+{
+	pthread_mutex_lock(&deque->lock);
+	deque->strands[deque->bottom++ % _strands_cnt] = strand;
+	pthread_mutex_unlock(&deque->lock);
+}
+
+/**
+* Pushes strand to the top (thieves side) of worker deque. Owner will take it last.
+*
+* @param	deque	worker deque
+* @param	strand	strand with ready nodes
+* @return	void
+*/
+void DequePushTop(struct workerDeque* deque, struct loopStrand* strand)
+{
+	pthread_mutex_lock(&deque->lock);
+	if (deque->top == 0)
+	{
+		deque->top += _strands_cnt;
+		deque->bottom += _strands_cnt;
+	}
+	deque->strands[--deque->top % _strands_cnt] = strand;
+	pthread_mutex_unlock(&deque->lock);
+}
+
+/**
+* Pops strand from the bottom of worker deque (newest first)
+*
+* @param	deque	worker deque
+* @return	strand or NULL if deque is empty
+*/
+struct loopStrand* DequePopBottom(struct workerDeque* deque)
+{
+	struct loopStrand* strand = NULL;
+
+	pthread_mutex_lock(&deque->lock);
+	if (deque->bottom > deque->top)
+		strand = deque->strands[--deque->bottom % _strands_cnt];
+	pthread_mutex_unlock(&deque->lock);
+	return strand;
+}
+
+/**
+* Steals strand from the top of worker deque (oldest first)
+*
+* @param	deque	victim's deque
+* @return	strand or NULL if deque is empty
+*/
+struct loopStrand* DequeSteal(struct workerDeque* deque)
+{
+	struct loopStrand* strand = NULL;
+
+	pthread_mutex_lock(&deque->lock);
+	if (deque->bottom > deque->top)
+	{
+		strand = deque->strands[deque->top++ % _strands_cnt];
+		// Keep positions small, they only matter modulo deque size
+		if (deque->top >= _strands_cnt)
+		{
+			deque->top -= _strands_cnt;
+			deque->bottom -= _strands_cnt;
+		}
+	}
+	pthread_mutex_unlock(&deque->lock);
+	return strand;
+}
+
+/**
+* Finds strand to work on. First own deque is checked, then other workers deques.
+*
+* @param	workerId	current worker
+* @return	strand or NULL if there is no ready strand
+*/
+struct loopStrand* FindStrand(int workerId)
+{
+	int i;
+	struct loopStrand* strand = DequePopBottom(&_deques[workerId]);
+
+	for (i = 1; strand == NULL && i < _workers_cnt; i++)
+		strand = DequeSteal(&_deques[(workerId + i) % _workers_cnt]);
+
+	return strand;
+}
+
+/**
+* Takes first ready node from strand
+*
+* @param	strand	loop strand
+* @return	node or NULL if strand has no ready nodes. In that case strand is no longer scheduled.
+*/
+Node* StrandPopNode(struct loopStrand* strand)
+{
+	Node* node;
+
+	pthread_mutex_lock(&strand->lock);
+	node = strand->head;
+	if (node)
+	{
+		strand->head = node->nextQueued;
+		if (!strand->head)
+			strand->tail = NULL;
+		node->isQueued = 0;
+	}
+	else
+		strand->isScheduled = 0;
+	pthread_mutex_unlock(&strand->lock);
+	return node;
+}
+
+/**
+* Worker main loop. Takes strand and executes its ready nodes.
+* Strand stays owned by worker while it executes its nodes, so no other worker can execute node from the same loop.
+* After STRAND_BUDGET nodes strand is put back to the top of deque, so other loops are not starved.
+*
+* @param	context		worker id
+* @return	void
+*/
+void* WorkerLoop(void* context)
+{
+	struct loopStrand* strand;
+	Node* node;
+	int budget;
+
+	_worker_id = (int)(size_t)context;
+
+	while (1)
+	{
+		strand = FindStrand(_worker_id);
+		if (strand == NULL)
+		{
+			// Check once more while holding idle mutex. Strand scheduling wakes idle workers after
+			// strand is pushed, so work can't be missed between this check and waiting
+			pthread_mutex_lock(&_idle_mutex);
+			_idle_workers_cnt++;
+			while ((strand = FindStrand(_worker_id)) == NULL)
+				pthread_cond_wait(&_idle_cond, &_idle_mutex);
+			_idle_workers_cnt--;
+			pthread_mutex_unlock(&_idle_mutex);
+		}
+
+		for (budget = STRAND_BUDGET; budget > 0 && (node = StrandPopNode(strand)) != NULL; budget--)
+			ExecuteScheduledNode(node);
+
+		if (budget == 0)
+			DequePushTop(&_deques[_worker_id], strand);
+	}
+	return NULL;
+}
+
+/**
+* Creates workers and loop strands
+*
+* @param	workersCnt	number of workers. If zero or less, one worker per core is created
+* @param	loopsCnt	number of loop locks
+* @return	void
+*/
+void SchedulerInit(int workersCnt, int loopsCnt)
+{
+	int i;
+
+	_strands_cnt = loopsCnt > 0 ? loopsCnt : 1;
+	_strands = calloc(_strands_cnt, sizeof(struct loopStrand));
+	for (i = 0; i < _strands_cnt; i++)
+		pthread_mutex_init(&_strands[i].lock, NULL);
+
+	pthread_cond_init(&_idle_cond, NULL);
+
+	_workers_cnt = workersCnt > 0 ? workersCnt : SchedulerGetCoresCount();
+	_deques = calloc(_workers_cnt, sizeof(struct workerDeque));
+	for (i = 0; i < _workers_cnt; i++)
+	{
+		pthread_mutex_init(&_deques[i].lock, NULL);
+		// Strand is scheduled at most once, so deque can't hold more strands than there are loops
+		_deques[i].strands = malloc(_strands_cnt * sizeof(struct loopStrand*));
+	}
+
+	_worker_threads = malloc(_workers_cnt * sizeof(pthread_t));
+	for (i = 0; i < _workers_cnt; i++)
+		pthread_create(&_worker_threads[i], NULL, WorkerLoop, (void*)(size_t)i);
+
+	printf("Worker pool started with %d workers...\n", _workers_cnt);
+}
+
+/**
+* Puts node on its loop queue. Node, that is already waiting in queue, is not added twice.
+* This matches thread per node mode, where multiple signals to paused node wake it up only once.
+*
+* If loop was idle, its strand is scheduled:
+*		+) on current worker's deque, when called from worker (eg. child nodes from OnNodeFinish)
+*		+) on workers deques in round robin, when called from other threads (eg. event generators)
+*
+* @param	node	node that is ready to run
+* @return	void
+*/
+void SchedulerEnqueueNode(Node* node)
+{
+	struct loopStrand* strand = &_strands[node->loopLockId];
+	int isNewlyScheduled = 0;
+
+	pthread_mutex_lock(&strand->lock);
+	if (!node->isQueued)
+	{
+		node->isQueued = 1;
+		node->nextQueued = NULL;
+		if (strand->tail)
+			strand->tail->nextQueued = node;
+		else
+			strand->head = node;
+		strand->tail = node;
+
+		if (!strand->isScheduled)
+		{
+			strand->isScheduled = 1;
+			isNewlyScheduled = 1;
+		}
+	}
+	pthread_mutex_unlock(&strand->lock);
+
+	if (!isNewlyScheduled)
+		return;
+
+	if (_worker_id >= 0)
+		DequePushBottom(&_deques[_worker_id], strand);
+
+	pthread_mutex_lock(&_idle_mutex);
+	if (_worker_id < 0)
+		DequePushBottom(&_deques[_next_deque++ % _workers_cnt], strand);
+	if (_idle_workers_cnt > 0)
+		pthread_cond_signal(&_idle_cond);
+	pthread_mutex_unlock(&_idle_mutex);
+}
+
+/**
+* Gets number of workers
+*
+* @return	number of workers, zero if worker pool is not started
+*/
+int SchedulerGetWorkersCount()
+{
+	return _workers_cnt;
+}
+
+/**
+* Gets number of online cores
+*
+* @return	number of cores, at least 1
+*/
+int SchedulerGetCoresCount()
+{
+	int cores;
+#if defined(_WIN32)
+	SYSTEM_INFO sysinfo;
+	GetSystemInfo(&sysinfo);
+	cores = sysinfo.dwNumberOfProcessors;
+#else
+	cores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+	return cores > 0 ? cores : 1;
+}
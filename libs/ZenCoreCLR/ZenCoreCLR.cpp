@@ -70,7 +70,8 @@ struct nodeData
 	char  id[50];
 	void *ptr;
 };
-struct  nodeData nodeDatas[1000];
+// Allocated in InitNodeDatas, one per project node
+struct  nodeData* nodeDatas = NULL;
 
 //Assembly data
 struct assemblyData
@@ -115,9 +116,6 @@ typedef int(*GetElementResultInfoCallback)(void*);
 typedef void**(*GetElementResultCallback)(void*);
 typedef void(*ExecuteElementCallback)(void*);
 
-// Pointer to event handler in node implementation
-typedef int(*ptrOnNodeEvent)(Node*, char*);
-
 // Node workflow functions
 typedef void  (InitUnmanagedElementsMethodFp)(char* currentNodeId, nodeData nodes[], int nodesCnt, int isManaged, char*  projectRoot, char* projectId, GetElementPropertyCallback getElementPropertyFp, GetElementResultInfoCallback getElementResultInfoFp, GetElementResultCallback getElementResultFp, ExecuteElementCallback executeElementFp, SetElementPropertyCallback setElementPropertyFp, AddEventToBufferCallback addEventToBufferFp);
 typedef void (OnElementInitMethodFp)(char* currentNodeId, nodeData nodes[], int nodesCnt, char* result);
@@ -136,9 +134,8 @@ typedef char* (GetDynamicElementsMethodFp)(char* currentNodeId, nodeData nodes[]
 */
 void managed_callback_add_event_to_buffer(void* node, char* data)
 {
-	ptrOnNodeEvent onNodeEventFunct = (ptrOnNodeEvent)GetFunction(((Node*)node)->implementation, "onNodeEvent");
-	if (onNodeEventFunct)
-		onNodeEventFunct((Node*)node,data);
+	if (((Node*)node)->vtable->onNodeEvent)
+		((Node*)node)->vtable->onNodeEvent((Node*)node,data);
 }
 
 /**
@@ -178,14 +175,38 @@ int managed_callback_get_node_result_info(void* node)
 }
 
 /**
-* Returns node result back to managed code
+* Returns node result back to managed code. Managed code runs on its own threads, so typed result is read
+* as thread-local snapshot, which stays consistent while node publishes new results.
+* Snapshot is returned in the same form as lastResult and is valid until next call from the same thread
 *
 * @param node		node to retrieve result
 * @return           node result
 */
 void** managed_callback_get_node_result(void* node)
 {
-	return ((Node*)node)->lastResult;
+	static thread_local zen_value_t snapshot;
+	static thread_local const void* snapshotData;
+
+	// Node doesn't publish typed result, only lastResult
+	if (ATOMIC_LOAD(&((Node*)node)->resultSequence) == 0)
+		return ((Node*)node)->lastResult;
+
+	common_result_snapshot((Node*)node, &snapshot);
+	switch (snapshot.type)
+	{
+		case RESULT_TYPE_INT:
+			return (void**)(intptr_t)snapshot.as.intValue;
+
+		case RESULT_TYPE_DOUBLE:
+		case RESULT_TYPE_BOOL:
+			snapshotData = &snapshot.as;
+			break;
+
+		default:
+			snapshotData = common_value_get_data(&snapshot);
+			break;
+	}
+	return (void**)&snapshotData;
 }
 
 /**
@@ -732,6 +753,7 @@ void InitNodeDatas()
 {
 	if (!_areNodeDatasInitialized)
 	{
+		nodeDatas = new nodeData[COMMON_NODE_LIST_LENGTH];
 		for (int i = 0; i < COMMON_NODE_LIST_LENGTH; i++)
 		{
 			strncpy(nodeDatas[i].id, COMMON_NODE_LIST[i]->id, strlen(COMMON_NODE_LIST[i]->id) + 1);